@@ -2,7 +2,12 @@
 #include "search.hpp"
 #include "eval.hpp"
 
-Move AI::findBestMove(Board& board, int depth) {
+Move AI::findBestMove(Board& board, int depth, int threads) {
     Search search;
+    search.setThreads(threads);
     return search.alphaBetaSearch(board, depth);
 }
+
+bool AI::isAITurn(const Board& board) {
+    return board.getAIPlayer() != PieceColor::EMPTY && board.getSideToMove() == board.getAIPlayer();
+}
@@ -6,7 +6,10 @@
 
 class AI {
 public:
-	static Move findBestMove(Board& board, int depth);
+	// Best move for the side to move. threads > 1 adds helper threads searching the same position through a shared hash table
+	static Move findBestMove(Board& board, int depth, int threads = 1);
+	// True when the side to move is the board's AI player, the only time the GUI hands the board to the search
+	static bool isAITurn(const Board& board);
 };
 
 #endif // AI_HPP
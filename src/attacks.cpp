@@ -0,0 +1,198 @@
+#include "attacks.hpp"
+
+Magic rookMagics[64];
+Magic bishopMagics[64];
+uint64_t knightAttackTable[64];
+uint64_t kingAttackTable[64];
+uint64_t pawnAttackTable[2][64];
+uint64_t betweenTable[64][64];
+uint64_t lineTable[64][64];
+
+// Shared attack tables, every square owns a slice of 2^(relevant bits) entries
+static uint64_t rookTable[102400];
+static uint64_t bishopTable[5248];
+
+static const int ROOK_DIRECTIONS[4][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+static const int BISHOP_DIRECTIONS[4][2] = { { -1, -1 }, { -1, 1 }, { 1, -1 }, { 1, 1 } };
+
+static bool onBoard(int row, int col) {
+    return row >= 0 && row < 8 && col >= 0 && col < 8;
+}
+
+// Walk the rays square-by-square. Only used while building the tables
+static uint64_t slidingAttacks(int square, uint64_t occupancy, const int directions[4][2]) {
+    uint64_t attacks = 0;
+
+    for (int i = 0; i < 4; ++i) {
+        int row = square / 8 + directions[i][0];
+        int col = square % 8 + directions[i][1];
+
+        while (onBoard(row, col)) {
+            uint64_t bit = squareBit(row * 8 + col);
+            attacks |= bit;
+            if (occupancy & bit) {
+                break; // The ray is blocked by this piece
+            }
+            row += directions[i][0];
+            col += directions[i][1];
+        }
+    }
+
+    return attacks;
+}
+
+// Relevant occupancy mask: the rays without the last square, since a piece on the edge never blocks anything
+static uint64_t relevantMask(int square, const int directions[4][2]) {
+    uint64_t mask = 0;
+
+    for (int i = 0; i < 4; ++i) {
+        int row = square / 8 + directions[i][0];
+        int col = square % 8 + directions[i][1];
+
+        while (onBoard(row + directions[i][0], col + directions[i][1])) {
+            mask |= squareBit(row * 8 + col);
+            row += directions[i][0];
+            col += directions[i][1];
+        }
+    }
+
+    return mask;
+}
+
+// Deterministic xorshift generator so the magics (and table layout) are the same on every run
+static uint64_t randomState = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t random64() {
+    randomState ^= randomState >> 12;
+    randomState ^= randomState << 25;
+    randomState ^= randomState >> 27;
+    return randomState * 2685821657736338717ULL;
+}
+
+// Magic candidates with few set bits work far better
+static uint64_t sparseRandom64() {
+    return random64() & random64() & random64();
+}
+
+static void initMagics(Magic magics[64], uint64_t* table, const int directions[4][2]) {
+    uint64_t occupancies[4096];
+    uint64_t references[4096];
+    int epoch[4096] = { 0 };
+    int attempt = 0;
+
+    uint64_t* nextSlice = table;
+
+    for (int square = 0; square < 64; ++square) {
+        Magic& m = magics[square];
+        m.mask = relevantMask(square, directions);
+        int bits = popCount(m.mask);
+        m.shift = 64 - bits;
+        m.attacks = nextSlice;
+
+        // Enumerate every subset of the mask (carry-rippler) and its attack set
+        int size = 0;
+        uint64_t subset = 0;
+        do {
+            occupancies[size] = subset;
+            references[size] = slidingAttacks(square, subset, directions);
+            ++size;
+            subset = (subset - m.mask) & m.mask;
+        } while (subset);
+
+        // Try random magics until one maps every subset without a destructive collision
+        bool found = false;
+        while (!found) {
+            m.magic = sparseRandom64();
+            if (popCount((m.mask * m.magic) >> 56) < 6) {
+                continue;
+            }
+
+            ++attempt;
+            found = true;
+            for (int i = 0; i < size; ++i) {
+                unsigned index = m.index(occupancies[i]);
+                if (epoch[index] < attempt) {
+                    epoch[index] = attempt;
+                    m.attacks[index] = references[i];
+                }
+                else if (m.attacks[index] != references[i]) {
+                    found = false;
+                    break;
+                }
+            }
+        }
+
+        nextSlice += size;
+    }
+}
+
+static void initLeaperTables() {
+    const int knightDr[] = { -2, -1, 1, 2, 2, 1, -1, -2 };
+    const int knightDc[] = { 1, 2, 2, 1, -1, -2, -2, -1 };
+    const int kingDr[] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+    const int kingDc[] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+
+    for (int square = 0; square < 64; ++square) {
+        int row = square / 8;
+        int col = square % 8;
+
+        knightAttackTable[square] = 0;
+        kingAttackTable[square] = 0;
+        for (int i = 0; i < 8; ++i) {
+            if (onBoard(row + knightDr[i], col + knightDc[i])) {
+                knightAttackTable[square] |= squareBit((row + knightDr[i]) * 8 + col + knightDc[i]);
+            }
+            if (onBoard(row + kingDr[i], col + kingDc[i])) {
+                kingAttackTable[square] |= squareBit((row + kingDr[i]) * 8 + col + kingDc[i]);
+            }
+        }
+
+        // White pawns move towards row 0, black pawns towards row 7
+        pawnAttackTable[0][square] = 0;
+        pawnAttackTable[1][square] = 0;
+        for (int dc = -1; dc <= 1; dc += 2) {
+            if (onBoard(row - 1, col + dc)) {
+                pawnAttackTable[0][square] |= squareBit((row - 1) * 8 + col + dc);
+            }
+            if (onBoard(row + 1, col + dc)) {
+                pawnAttackTable[1][square] |= squareBit((row + 1) * 8 + col + dc);
+            }
+        }
+    }
+}
+
+// Needs the magic tables, the rays are read back from them on an empty board
+static void initLineTables() {
+    for (int from = 0; from < 64; ++from) {
+        for (int to = 0; to < 64; ++to) {
+            betweenTable[from][to] = 0;
+            lineTable[from][to] = 0;
+            if (from == to) {
+                continue;
+            }
+
+            uint64_t bits = squareBit(from) | squareBit(to);
+            if (rookAttacks(from, 0) & squareBit(to)) {
+                betweenTable[from][to] = rookAttacks(from, bits) & rookAttacks(to, bits);
+                lineTable[from][to] = (rookAttacks(from, 0) & rookAttacks(to, 0)) | bits;
+            }
+            else if (bishopAttacks(from, 0) & squareBit(to)) {
+                betweenTable[from][to] = bishopAttacks(from, bits) & bishopAttacks(to, bits);
+                lineTable[from][to] = (bishopAttacks(from, 0) & bishopAttacks(to, 0)) | bits;
+            }
+        }
+    }
+}
+
+static bool buildAttackTables() {
+    initLeaperTables();
+    initMagics(rookMagics, rookTable, ROOK_DIRECTIONS);
+    initMagics(bishopMagics, bishopTable, BISHOP_DIRECTIONS);
+    initLineTables();
+    return true;
+}
+
+void initAttackTables() {
+    static const bool initialized = buildAttackTables();
+    (void)initialized;
+}
@@ -0,0 +1,105 @@
+#ifndef ATTACKS_HPP
+#define ATTACKS_HPP
+
+#include <cstdint>
+#include "types.hpp"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Squares are numbered row * 8 + col, the same layout the Board bitboards use
+// (square 0 is the top-left corner of the board, black's queen-side rook).
+
+// Magic bitboard entry for one square: the relevant occupancy mask, the magic
+// multiplier and a pointer into the shared attack table for that square
+struct Magic {
+	uint64_t mask;
+	uint64_t magic;
+	uint64_t* attacks;
+	int shift;
+
+	unsigned index(uint64_t occupancy) const {
+		return (unsigned)(((occupancy & mask) * magic) >> shift);
+	}
+};
+
+extern Magic rookMagics[64];
+extern Magic bishopMagics[64];
+extern uint64_t knightAttackTable[64];
+extern uint64_t kingAttackTable[64];
+extern uint64_t pawnAttackTable[2][64];
+extern uint64_t betweenTable[64][64];
+extern uint64_t lineTable[64][64];
+
+// Builds the magic and leaper tables. Safe to call more than once, the tables are only built the first time
+void initAttackTables();
+
+inline uint64_t rookAttacks(int square, uint64_t occupancy) {
+	const Magic& m = rookMagics[square];
+	return m.attacks[m.index(occupancy)];
+}
+
+inline uint64_t bishopAttacks(int square, uint64_t occupancy) {
+	const Magic& m = bishopMagics[square];
+	return m.attacks[m.index(occupancy)];
+}
+
+inline uint64_t queenAttacks(int square, uint64_t occupancy) {
+	return rookAttacks(square, occupancy) | bishopAttacks(square, occupancy);
+}
+
+inline uint64_t knightAttacks(int square) {
+	return knightAttackTable[square];
+}
+
+inline uint64_t kingAttacks(int square) {
+	return kingAttackTable[square];
+}
+
+// Squares attacked by a pawn of the given color standing on the square
+inline uint64_t pawnAttacks(PieceColor color, int square) {
+	return pawnAttackTable[color == PieceColor::WHITE ? 0 : 1][square];
+}
+
+// Squares strictly between two squares on a shared rank, file or diagonal (empty otherwise)
+inline uint64_t betweenSquares(int from, int to) {
+	return betweenTable[from][to];
+}
+
+// The whole rank, file or diagonal through both squares (empty if they don't share one)
+inline uint64_t lineThrough(int from, int to) {
+	return lineTable[from][to];
+}
+
+inline uint64_t squareBit(int square) {
+	return (uint64_t)1 << square;
+}
+
+inline int popCount(uint64_t bitboard) {
+#if defined(_MSC_VER)
+	return (int)__popcnt64(bitboard);
+#else
+	return __builtin_popcountll(bitboard);
+#endif
+}
+
+// Index of the least significant set bit. The bitboard must not be empty
+inline int bitScanForward(uint64_t bitboard) {
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, bitboard);
+	return (int)index;
+#else
+	return __builtin_ctzll(bitboard);
+#endif
+}
+
+// Returns the least significant set bit and clears it from the bitboard
+inline int popLSB(uint64_t& bitboard) {
+	int square = bitScanForward(bitboard);
+	bitboard &= bitboard - 1;
+	return square;
+}
+
+#endif // ATTACKS_HPP
@@ -1,404 +1,768 @@
 #include "board.hpp"
 #include <iostream>
 #include <string>
+#include <string_view>
 #include "move.hpp"
 #include "movegen.hpp"
+#include "attacks.hpp"
+#include "zobrist.hpp"
+#include "log.hpp"
+#include <cassert>
 #include <unordered_map>
 
 Board::Board() {
-    //Initialize the pieceMoved array to false
-    for (int row = 0; row < BOARD_SIZE; ++row) {
-        for (int col = 0; col < BOARD_SIZE; ++col) {
-            pieceMoved[row][col] = false;
+    //Make sure the attack tables used by move generation are built
+    initAttackTables();
+    initZobristKeys();
+
+    clearBoard();
+
+    //No piece has moved yet
+    movedSquares = 0;
+    enPassantSquare = -1;
+    sideToMove = PieceColor::WHITE;
+    halfmoveClock = 0;
+    fullmoveNumber = 1;
+    //No side is played by the AI until the GUI assigns one
+    aiPlayer = PieceColor::EMPTY;
+    realPlayer = PieceColor::EMPTY;
+    hashKey = computeHashKey();
+    updateAttackMaps();
+
+    //Reserve room for a deep search plus a long game so making moves never reallocates
+    undoStack.reserve(1024);
+}
+
+void Board::initializeFromFEN() {
+    setFromFEN(START_FEN);
+}
+
+// Letter used for each PieceType in FEN, lowercase (black)
+static const char FEN_PIECE_CHARS[6] = { 'p', 'r', 'n', 'b', 'q', 'k' };
+
+// Reads a non-negative decimal number starting at pos, returns -1 if there is none
+static int parseFENNumber(std::string_view fen, size_t& pos) {
+    if (pos >= fen.size() || fen[pos] < '0' || fen[pos] > '9') {
+        return -1;
+    }
+    int value = 0;
+    while (pos < fen.size() && fen[pos] >= '0' && fen[pos] <= '9') {
+        value = value * 10 + (fen[pos] - '0');
+        if (value > 100000) {
+            return -1;
         }
+        ++pos;
     }
+    return value;
 }
 
-void Board::initializeFromFEN() {
-    // Clear all the bitboards
-    whitePawns = 0;
-    whiteKnights = 0;
-    whiteBishops = 0;
-    whiteRooks = 0;
-    whiteQueens = 0;
-    whiteKing = 0;
-    blackPawns = 0;
-    blackKnights = 0;
-    blackBishops = 0;
-    blackRooks = 0;
-    blackQueens = 0;
-    blackKing = 0;
-
-    // We can iterate through the rows of the FEN string and populate the bitboards accordingly
-    int row = 0; // Start from the 8th row (top row of the board)
-    int col = 0;
+static void skipFENSpaces(std::string_view fen, size_t& pos) {
+    while (pos < fen.size() && fen[pos] == ' ') {
+        ++pos;
+    }
+}
 
-    std::string fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR";
+bool Board::setFromFEN(std::string_view fen, std::string_view* error) {
+    // Everything is parsed into locals first, so the board is left untouched if the FEN is invalid
+    PieceType types[64];
+    PieceColor colors[64];
+    for (int square = 0; square < 64; ++square) {
+        types[square] = PieceType::EMPTY;
+        colors[square] = PieceColor::EMPTY;
+    }
 
-    for (const char& c : fen) {
+    auto fail = [error](const char* message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+
+    // Piece placement, starting from the 8th rank (row 0)
+    size_t pos = 0;
+    skipFENSpaces(fen, pos);
+    int row = 0;
+    int col = 0;
+    int kings[2] = { 0, 0 };
+    for (; pos < fen.size() && fen[pos] != ' '; ++pos) {
+        char c = fen[pos];
         if (c == '/') {
-            // '/' indicates the end of a row, so move to the next row
+            if (col != 8 || row == 7) {
+                return fail("FEN rank does not have 8 squares");
+            }
             row++;
-            col = 0; // Reset the column for the new row
+            col = 0;
         }
         else if (c >= '1' && c <= '8') {
-            // If c is a digit between '1' and '8', it represents an empty square
-            // We skip the corresponding number of squares
-            col += (c - '0'); // Move the number of squares ahead
+            col += (c - '0');
+            if (col > 8) {
+                return fail("FEN rank does not have 8 squares");
+            }
         }
         else {
-            // If c is a letter, it represents a piece on the board
-            // We need to find its position and set the corresponding bit in the appropriate bitboard
+            PieceColor pieceColor = islower((unsigned char)c) ? PieceColor::BLACK : PieceColor::WHITE;
+            int type = 0;
+            while (type < 6 && FEN_PIECE_CHARS[type] != tolower((unsigned char)c)) {
+                ++type;
+            }
+            if (type == 6) {
+                return fail("Unknown piece letter in FEN");
+            }
+            if (col >= 8) {
+                return fail("FEN rank does not have 8 squares");
+            }
+            if ((PieceType)type == PieceType::PAWN && (row == 0 || row == 7)) {
+                return fail("Pawn on the first or last rank in FEN");
+            }
+            if ((PieceType)type == PieceType::KING) {
+                kings[(int)pieceColor]++;
+            }
+            types[row * 8 + col] = (PieceType)type;
+            colors[row * 8 + col] = pieceColor;
+            col++;
+        }
+    }
+    if (row != 7 || col != 8) {
+        return fail("FEN placement does not have 8 ranks");
+    }
+    if (kings[0] != 1 || kings[1] != 1) {
+        return fail("FEN needs exactly one king of each color");
+    }
 
-            // Determine the piece type and color based on the character c
-            PieceType pieceType;
-            PieceColor pieceColor;
+    // Side to move
+    skipFENSpaces(fen, pos);
+    if (pos >= fen.size() || (fen[pos] != 'w' && fen[pos] != 'b')) {
+        return fail("FEN side to move must be 'w' or 'b'");
+    }
+    PieceColor side = (fen[pos] == 'w') ? PieceColor::WHITE : PieceColor::BLACK;
+    ++pos;
+
+    // Castling rights. A missing right marks that rook's home square as moved, which is how
+    // makeMove records a lost right, so the rest of the engine sees no difference
+    skipFENSpaces(fen, pos);
+    uint64_t moved = ((uint64_t)1 << 63) | ((uint64_t)1 << 56) | ((uint64_t)1 << 7) | ((uint64_t)1 << 0);
+    if (pos < fen.size() && fen[pos] == '-') {
+        ++pos;
+    }
+    else {
+        bool any = false;
+        for (; pos < fen.size() && fen[pos] != ' '; ++pos) {
+            int kingSquare, rookSquare;
+            PieceColor color;
+            switch (fen[pos]) {
+            case 'K': kingSquare = 60; rookSquare = 63; color = PieceColor::WHITE; break;
+            case 'Q': kingSquare = 60; rookSquare = 56; color = PieceColor::WHITE; break;
+            case 'k': kingSquare = 4; rookSquare = 7; color = PieceColor::BLACK; break;
+            case 'q': kingSquare = 4; rookSquare = 0; color = PieceColor::BLACK; break;
+            default: return fail("Unknown castling right in FEN");
+            }
+            if (types[kingSquare] != PieceType::KING || colors[kingSquare] != color ||
+                types[rookSquare] != PieceType::ROOK || colors[rookSquare] != color) {
+                return fail("FEN castling right without the king and rook on their home squares");
+            }
+            moved &= ~((uint64_t)1 << rookSquare);
+            any = true;
+        }
+        if (!any) {
+            return fail("FEN is missing the castling field");
+        }
+    }
+
+    // En passant target square, which must be on the square a pawn of the side not to move just skipped
+    skipFENSpaces(fen, pos);
+    int epSquare = -1;
+    if (pos < fen.size() && fen[pos] == '-') {
+        ++pos;
+    }
+    else {
+        if (pos + 1 >= fen.size() || fen[pos] < 'a' || fen[pos] > 'h' || fen[pos + 1] < '1' || fen[pos + 1] > '8') {
+            return fail("FEN en passant square is invalid");
+        }
+        int epCol = fen[pos] - 'a';
+        int epRow = 8 - (fen[pos + 1] - '0');
+        int pawnRow = (side == PieceColor::WHITE) ? epRow + 1 : epRow - 1;
+        if (epRow != (side == PieceColor::WHITE ? 2 : 5) ||
+            types[pawnRow * 8 + epCol] != PieceType::PAWN || colors[pawnRow * 8 + epCol] == side) {
+            return fail("FEN en passant square is invalid");
+        }
+        epSquare = epRow * 8 + epCol;
+        pos += 2;
+    }
+
+    // Move clocks are optional, so EPD-style positions load too
+    int halfmove = 0;
+    int fullmove = 1;
+    skipFENSpaces(fen, pos);
+    if (pos < fen.size()) {
+        halfmove = parseFENNumber(fen, pos);
+        skipFENSpaces(fen, pos);
+        fullmove = parseFENNumber(fen, pos);
+        if (halfmove < 0 || fullmove < 1) {
+            return fail("FEN move clocks are invalid");
+        }
+    }
+    skipFENSpaces(fen, pos);
+    if (pos != fen.size()) {
+        return fail("Unexpected characters at the end of the FEN");
+    }
 
-            char lowerC = tolower(c);
+    // Everything is valid, set up the board
+    clearBoard();
+    for (int square = 0; square < 64; ++square) {
+        if (types[square] != PieceType::EMPTY) {
+            addPiece(square, types[square], colors[square]);
+        }
+    }
+    movedSquares = moved;
+    enPassantSquare = epSquare;
+    sideToMove = side;
+    halfmoveClock = halfmove;
+    fullmoveNumber = fullmove;
+    undoStack.clear();
+    hashKey = computeHashKey();
+    updateAttackMaps();
+
+    if (error) {
+        *error = std::string_view();
+    }
+    return true;
+}
 
-            if (islower(c)) {
-                // It's a black piece
-                pieceColor = PieceColor::BLACK;
+std::string Board::toFEN() const {
+    std::string fen;
+    fen.reserve(96);
+
+    for (int row = 0; row < 8; ++row) {
+        int emptyCount = 0;
+        for (int col = 0; col < 8; ++col) {
+            int square = row * 8 + col;
+            if (squareType[square] == PieceType::EMPTY) {
+                emptyCount++;
+                continue;
             }
-            else {
-                // It's a white piece
-                pieceColor = PieceColor::WHITE;
+            if (emptyCount > 0) {
+                fen += (char)('0' + emptyCount);
+                emptyCount = 0;
             }
+            char c = FEN_PIECE_CHARS[(int)squareType[square]];
+            fen += (squareColor[square] == PieceColor::WHITE) ? (char)toupper(c) : c;
+        }
+        if (emptyCount > 0) {
+            fen += (char)('0' + emptyCount);
+        }
+        if (row < 7) {
+            fen += '/';
+        }
+    }
+
+    fen += (sideToMove == PieceColor::WHITE) ? " w " : " b ";
 
-            switch (lowerC) {
-            case 'r': pieceType = PieceType::ROOK; break;
-            case 'n': pieceType = PieceType::KNIGHT; break;
-            case 'b': pieceType = PieceType::BISHOP; break;
-            case 'q': pieceType = PieceType::QUEEN; break;
-            case 'k': pieceType = PieceType::KING; break;
-            case 'p': pieceType = PieceType::PAWN; break;
-            default: continue; // Ignore any other characters (like spaces)
+    int rights = getCastlingRights();
+    if (rights == 0) {
+        fen += '-';
+    }
+    else {
+        const char rightChars[4] = { 'K', 'Q', 'k', 'q' };
+        for (int i = 0; i < 4; ++i) {
+            if (rights & (1 << i)) {
+                fen += rightChars[i];
             }
+        }
+    }
 
-            // Calculate the bit position of the piece based on the row and column
-            int position = row * 8 + col;
+    fen += ' ';
+    if (enPassantSquare == -1) {
+        fen += '-';
+    }
+    else {
+        fen += (char)('a' + enPassantSquare % 8);
+        fen += (char)('8' - enPassantSquare / 8);
+    }
 
-            // Set the bit in the appropriate bitboard based on the piece color and type
-            if (pieceColor == PieceColor::WHITE) {
-                switch (pieceType) {
-                case PieceType::PAWN: whitePawns |= (uint64_t)1 << position; break;
-                case PieceType::ROOK: whiteRooks |= (uint64_t)1 << position; break;
-                case PieceType::KNIGHT: whiteKnights |= (uint64_t)1 << position; break;
-                case PieceType::BISHOP: whiteBishops |= (uint64_t)1 << position; break;
-                case PieceType::QUEEN: whiteQueens |= (uint64_t)1 << position; break;
-                case PieceType::KING: whiteKing |= (uint64_t)1 << position; break;
-                default: continue; // Ignore any other pieces (shouldn't happen)
-                }
-            }
-            else if (pieceColor == PieceColor::BLACK) {
-                switch (pieceType) {
-                case PieceType::PAWN: blackPawns |= (uint64_t)1 << position; break;
-                case PieceType::ROOK: blackRooks |= (uint64_t)1 << position; break;
-                case PieceType::KNIGHT: blackKnights |= (uint64_t)1 << position; break;
-                case PieceType::BISHOP: blackBishops |= (uint64_t)1 << position; break;
-                case PieceType::QUEEN: blackQueens |= (uint64_t)1 << position; break;
-                case PieceType::KING: blackKing |= (uint64_t)1 << position; break;
-                default: continue; // Ignore any other pieces (shouldn't happen)
-                }
-            }
+    fen += ' ';
+    fen += std::to_string(halfmoveClock);
+    fen += ' ';
+    fen += std::to_string(fullmoveNumber);
+    return fen;
+}
 
-            // Move to the next column
-            col++;
+void Board::clearBoard() {
+    for (int color = 0; color < 2; ++color) {
+        for (int type = 0; type < 6; ++type) {
+            pieceBitboards[color][type] = 0;
         }
     }
+    whiteOccupancy = 0;
+    blackOccupancy = 0;
+    allOccupancy = 0;
+    hashKey = 0;
+
+    for (int square = 0; square < 64; ++square) {
+        squareType[square] = PieceType::EMPTY;
+        squareColor[square] = PieceColor::EMPTY;
+    }
 }
 
+// Put a piece on an empty square, keeping the bitboards, occupancy and square array in sync
+void Board::addPiece(int square, PieceType type, PieceColor color) {
+    uint64_t bit = (uint64_t)1 << square;
 
-bool Board::isValidMove(int srcRow, int srcCol, int destRow, int destCol) const {
-    if (!isValidPosition(srcRow, srcCol) || !isValidPosition(destRow, destCol)) {
-        return false;
+    pieceBitboards[(int)color][(int)type] |= bit;
+    if (color == PieceColor::WHITE) {
+        whiteOccupancy |= bit;
+    }
+    else {
+        blackOccupancy |= bit;
     }
+    allOccupancy |= bit;
 
-    //Get the piece type and color of the source square
-    PieceType pieceType = getPieceType(srcRow, srcCol);
-    PieceColor pieceColor = getPieceColor(srcRow, srcCol);
+    squareType[square] = type;
+    squareColor[square] = color;
 
-    PieceType pieceTypeDest = getPieceType(destRow, destCol);
-    PieceColor pieceColorDest = getPieceColor(destRow, destCol);
+    hashKey ^= zobristPieces[(int)color][(int)type][square];
+}
 
-    //Generate moves for the selected piece (*this is passing the actual board)
-    std::vector<Move> movesForPiece;
+// Remove whatever piece is on the square
+void Board::clearSquare(int square) {
+    PieceType type = squareType[square];
+    PieceColor color = squareColor[square];
+    if (type == PieceType::EMPTY) {
+        return;
+    }
 
-    switch (pieceType) {
-    case PieceType::PAWN:
-        movesForPiece = generatePawnMoves(const_cast<Board&>(*this), srcRow, srcCol);
-        break;
+    uint64_t bit = (uint64_t)1 << square;
 
-    case PieceType::ROOK:
-        movesForPiece = generateRookMoves(*this, srcRow, srcCol);
-        break;
+    pieceBitboards[(int)color][(int)type] &= ~bit;
+    whiteOccupancy &= ~bit;
+    blackOccupancy &= ~bit;
+    allOccupancy &= ~bit;
 
-    case PieceType::KNIGHT:
-        movesForPiece = generateKnightMoves(*this, srcRow, srcCol);
-        break;
+    squareType[square] = PieceType::EMPTY;
+    squareColor[square] = PieceColor::EMPTY;
 
-    case PieceType::BISHOP:
-        movesForPiece = generateBishopMoves(*this, srcRow, srcCol);
-        break;
+    hashKey ^= zobristPieces[(int)color][(int)type][square];
+}
 
-    case PieceType::QUEEN:
-        movesForPiece = generateQueenMoves(*this, srcRow, srcCol);
-        break;
+// A right is kept while neither the king nor that rook has left (or been captured on) its home square
+int Board::getCastlingRights() const {
+    // King and rook home squares for each right, in the order of the rights bits
+    static const uint64_t homeSquares[4] = {
+        ((uint64_t)1 << 60) | ((uint64_t)1 << 63), // e1, h1
+        ((uint64_t)1 << 60) | ((uint64_t)1 << 56), // e1, a1
+        ((uint64_t)1 << 4) | ((uint64_t)1 << 7),   // e8, h8
+        ((uint64_t)1 << 4) | ((uint64_t)1 << 0)    // e8, a8
+    };
+
+    int rights = 0;
+    for (int i = 0; i < 4; ++i) {
+        if (!(movedSquares & homeSquares[i])) {
+            rights |= 1 << i;
+        }
+    }
+    return rights;
+}
 
-    case PieceType::KING:
-        movesForPiece = generateKingMoves(*this, srcRow, srcCol);
-        break;
+uint64_t Board::computeHashKey() const {
+    uint64_t key = 0;
 
-    default:
-        std::cout << "Oopsies.." << std::endl;
-        // Invalid piece type
-        return true;
+    uint64_t pieces = allOccupancy;
+    while (pieces) {
+        int square = popLSB(pieces);
+        key ^= zobristPieces[(int)squareColor[square]][(int)squareType[square]][square];
     }
 
-    //Check if the desired move is in the list of valid moves
-    for (const Move& move : movesForPiece) {
-        if (move.srcRow == srcRow && move.srcCol == srcCol && move.destRow == destRow && move.destCol == destCol) {
-            return true; //Move is valid
-        }
+    key ^= zobristCastling[getCastlingRights()];
+    if (enPassantSquare != -1) {
+        key ^= zobristEnPassant[enPassantSquare % 8];
+    }
+    if (sideToMove == PieceColor::BLACK) {
+        key ^= zobristSide;
     }
+    return key;
+}
 
-    // Check for castling move
-    if (pieceType == PieceType::KING && pieceTypeDest == PieceType::ROOK) {
-        // Inside the "King-side castling" block
-        if (!hasPieceMoved(srcRow, srcCol + 2) &&
-            isEmpty(srcRow, srcCol + 1) && isEmpty(srcRow, srcCol + 2) &&
-            !isSquareAttacked(*this, srcRow, srcCol + 1, getOppositeColor(pieceColor)) &&
-            !isSquareAttacked(*this, srcRow, srcCol + 2, getOppositeColor(pieceColor))) {
+// Hash in the castling rights, en passant file and side to move after the pieces have been moved
+void Board::finishMove(int previousEnPassantSquare, int previousCastlingRights) {
+    int castlingRights = getCastlingRights();
+    if (castlingRights != previousCastlingRights) {
+        hashKey ^= zobristCastling[previousCastlingRights] ^ zobristCastling[castlingRights];
+    }
+    if (previousEnPassantSquare != -1) {
+        hashKey ^= zobristEnPassant[previousEnPassantSquare % 8];
+    }
+    if (enPassantSquare != -1) {
+        hashKey ^= zobristEnPassant[enPassantSquare % 8];
+    }
 
-            // Move the king and rook to their new positions
-            return true;
-        }
+    sideToMove = getOppositeColor(sideToMove);
+    hashKey ^= zobristSide;
 
-        // Inside the "Queen-side castling" block
-        if (!hasPieceMoved(srcRow, srcCol - 2) &&
-            isEmpty(srcRow, srcCol - 1) && isEmpty(srcRow, srcCol - 2) && isEmpty(srcRow, srcCol - 3) &&
-            !isSquareAttacked(*this, srcRow, srcCol - 1, getOppositeColor(pieceColor)) &&
-            !isSquareAttacked(*this, srcRow, srcCol - 2, getOppositeColor(pieceColor))) {
+    updateAttackMaps();
 
-            // Move the king and rook to their new positions
-            return true;
-        }
+    assert(hashKey == computeHashKey());
+}
+
+// Every square attacked by the given color with the current occupancy
+uint64_t Board::computeAttacks(PieceColor color) const {
+    const uint64_t fileA = 0x0101010101010101ULL;
+    const uint64_t fileH = fileA << 7;
+    const uint64_t (&pieces)[6] = pieceBitboards[(int)color];
+
+    // Pawns set-wise: white pawns capture towards row 0 (lower squares), black pawns towards row 7
+    uint64_t pawns = pieces[(int)PieceType::PAWN];
+    uint64_t attacks;
+    if (color == PieceColor::WHITE) {
+        attacks = ((pawns & ~fileA) >> 9) | ((pawns & ~fileH) >> 7);
+    }
+    else {
+        attacks = ((pawns & ~fileA) << 7) | ((pawns & ~fileH) << 9);
+    }
+
+    uint64_t knights = pieces[(int)PieceType::KNIGHT];
+    while (knights) {
+        attacks |= knightAttacks(popLSB(knights));
+    }
 
+    uint64_t diagonal = pieces[(int)PieceType::BISHOP] | pieces[(int)PieceType::QUEEN];
+    while (diagonal) {
+        attacks |= bishopAttacks(popLSB(diagonal), allOccupancy);
     }
 
+    uint64_t straight = pieces[(int)PieceType::ROOK] | pieces[(int)PieceType::QUEEN];
+    while (straight) {
+        attacks |= rookAttacks(popLSB(straight), allOccupancy);
+    }
 
-    return false; //Move is invalid
+    uint64_t king = pieces[(int)PieceType::KING];
+    if (king) {
+        attacks |= kingAttacks(bitScanForward(king));
+    }
+    return attacks;
 }
 
-bool Board::makeMove(int srcRow, int srcCol, int destRow, int destCol, PieceType promotionPiece){
-    if (!isValidMove(srcRow, srcCol, destRow, destCol)) {
-        return false; // Invalid move
+// Refresh the attack maps, and from them the pieces giving check to the side to move
+void Board::updateAttackMaps() {
+    attackMaps[(int)PieceColor::WHITE] = computeAttacks(PieceColor::WHITE);
+    attackMaps[(int)PieceColor::BLACK] = computeAttacks(PieceColor::BLACK);
+
+    checkers = 0;
+    PieceColor enemyColor = getOppositeColor(sideToMove);
+    uint64_t king = pieceBitboards[(int)sideToMove][(int)PieceType::KING];
+    if (attackMaps[(int)enemyColor] & king) {
+        checkers = attackersTo(bitScanForward(king), allOccupancy) & getOccupancy(enemyColor);
     }
+}
 
-    // Get the piece at the source position
-    PieceType pieceTypeSrc = getPieceType(srcRow, srcCol);
-    PieceColor pieceColorSrc = getPieceColor(srcRow, srcCol);
-    // Get the piece at the destination position
-    PieceType pieceTypeDest = getPieceType(destRow, destCol);
-    PieceColor pieceColorDest = getPieceColor(destRow, destCol);
 
+bool Board::isValidMove(int srcRow, int srcCol, int destRow, int destCol) const {
+    if (!isValidPosition(srcRow, srcCol) || !isValidPosition(destRow, destCol)) {
+        return false;
+    }
+
+    // This API doesn't carry a promotion piece, so a pawn reaching the last row is checked as a queen promotion
+    Move move(srcRow, srcCol, destRow, destCol);
+    int lastRow = (squareColor[srcRow * 8 + srcCol] == PieceColor::WHITE) ? 0 : 7;
+    if (squareType[srcRow * 8 + srcCol] == PieceType::PAWN && destRow == lastRow) {
+        move.promotionPiece = PieceType::QUEEN;
+    }
+    return isPseudoLegal(move);
+}
 
-    //HANDLE THE CASTLING MOVE
-    if (pieceTypeSrc == PieceType::KING && pieceTypeDest == PieceType::ROOK) {
-        std::cout << "Entering castling mode";
-        std::cout << "Dest col: " << destCol;
-        std::cout << "Src col: " << srcCol;
-        // Kingside castling
-        if (destCol == 7) {  // Kingside castling
-            if (pieceColorSrc == PieceColor::WHITE) {
-                std::cout << "White kingside castling" << std::endl;
+bool Board::isPseudoLegal(const Move& move) const {
+    if (!isValidPosition(move.srcRow, move.srcCol) || !isValidPosition(move.destRow, move.destCol)) {
+        return false;
+    }
 
-                whiteKing &= ~((uint64_t)1 << (srcRow * 8 + srcCol));
-                whiteKing |= ((uint64_t)1 << (destRow * 8 + destCol - 1));
+    int srcSquare = move.srcRow * 8 + move.srcCol;
+    int destSquare = move.destRow * 8 + move.destCol;
+    PieceType pieceType = squareType[srcSquare];
+    PieceColor pieceColor = squareColor[srcSquare];
+    if (pieceType == PieceType::EMPTY) {
+        return false;
+    }
 
-                whiteRooks &= ~((uint64_t)1 << (destRow * 8 + 7));
-                whiteRooks |= ((uint64_t)1 << (destRow * 8 + 5));
+    uint64_t destBit = (uint64_t)1 << destSquare;
+    uint64_t own = getOccupancy(pieceColor);
+    PieceColor enemyColor = getOppositeColor(pieceColor);
 
-                // Clear the original king position after castling
+    // Only pawns reaching the last row promote, and they have to
+    int lastRow = (pieceColor == PieceColor::WHITE) ? 0 : 7;
+    bool promotes = pieceType == PieceType::PAWN && move.destRow == lastRow;
+    if (promotes != (move.promotionPiece != PieceType::EMPTY)) {
+        return false;
+    }
+    if (promotes && (move.promotionPiece == PieceType::PAWN || move.promotionPiece == PieceType::KING)) {
+        return false;
+    }
 
+    // Castling is the king moving onto its own rook, the generator checks the rest of the conditions
+    if (pieceType == PieceType::KING && squareType[destSquare] == PieceType::ROOK && squareColor[destSquare] == pieceColor) {
+        MoveList castlingMoves;
+        generateCastlingMoves(*this, move.srcRow, move.srcCol, castlingMoves);
+        for (const Move& castling : castlingMoves) {
+            if (castling.destRow == move.destRow && castling.destCol == move.destCol) {
+                return true;
             }
-            else {
-                blackKing &= ~((uint64_t)1 << (srcRow * 8 + srcCol));
-                blackKing |= ((uint64_t)1 << (destRow * 8 + destCol - 1));
+        }
+        return false;
+    }
 
-                blackRooks &= ~((uint64_t)1 << (destRow * 8 + 7));
-                blackRooks |= ((uint64_t)1 << (destRow * 8 + 5));
+    if (own & destBit) {
+        return false;
+    }
 
-                blackKing &= ~((uint64_t)1 << (0 * 8 + 7));
+    switch (pieceType) {
+    case PieceType::PAWN: {
+        int forward = (pieceColor == PieceColor::WHITE) ? -8 : 8;
+        if (move.srcCol == move.destCol) {
+            // Pushes need empty squares
+            if (destSquare == srcSquare + forward) {
+                return !(allOccupancy & destBit);
             }
-
+            int startRow = (pieceColor == PieceColor::WHITE) ? 6 : 1;
+            if (move.srcRow == startRow && destSquare == srcSquare + 2 * forward) {
+                return !(allOccupancy & (destBit | ((uint64_t)1 << (srcSquare + forward))));
+            }
+            return false;
+        }
+        // Captures land on an enemy piece, or on the square an enemy pawn skipped with its double push
+        if (!(pawnAttacks(pieceColor, srcSquare) & destBit)) {
+            return false;
         }
-        else if (destCol == 0) {
-            // Queenside castling
-            // Move the king and the rook to their proper positions
-            if (pieceColorSrc == PieceColor::WHITE) {
-                std::cout << "White queenside castling" << std::endl;
+        return (getOccupancy(enemyColor) & destBit) ||
+            (destSquare == enPassantSquare && move.destRow == (pieceColor == PieceColor::WHITE ? 2 : 5));
+    }
+    case PieceType::KNIGHT:
+        return (knightAttacks(srcSquare) & destBit) != 0;
+    case PieceType::BISHOP:
+        return (bishopAttacks(srcSquare, allOccupancy) & destBit) != 0;
+    case PieceType::ROOK:
+        return (rookAttacks(srcSquare, allOccupancy) & destBit) != 0;
+    case PieceType::QUEEN:
+        return (queenAttacks(srcSquare, allOccupancy) & destBit) != 0;
+    case PieceType::KING:
+        // Like the king generator, never step onto a square the other side attacks
+        return (kingAttacks(srcSquare) & destBit) && !(attackMaps[(int)enemyColor] & destBit);
+    default:
+        return false;
+    }
+}
 
-                whiteKing &= ~((uint64_t)1 << (srcRow * 8 + srcCol));
-                whiteKing |= ((uint64_t)1 << (destRow * 8 + destCol + 2));
+bool Board::makeMove(int srcRow, int srcCol, int destRow, int destCol, PieceType promotionPiece){
+    // Moves from outside the engine are checked here, everything after this trusts the move
+    Move move(srcRow, srcCol, destRow, destCol, MoveType::QUIET, promotionPiece);
+    if (!isPseudoLegal(move)) {
+        return false; // Invalid move
+    }
 
-                whiteRooks &= ~((uint64_t)1 << (destRow * 8 + 0));
-                whiteRooks |= ((uint64_t)1 << (destRow * 8 + 3));
+    makeMove(move);
+    return true;
+}
 
-                // Clear the original king position after castling
-                whiteKing &= ~((uint64_t)1 << (0 * 8));
+void Board::makeMove(const Move& move) {
+    int srcRow = move.srcRow;
+    int srcCol = move.srcCol;
+    int destRow = move.destRow;
+    int destCol = move.destCol;
+    PieceType promotionPiece = move.promotionPiece;
 
-            }
-            else {
-                blackKing &= ~((uint64_t)1 << (srcRow * 8 + srcCol));
-                blackKing |= ((uint64_t)1 << (destRow * 8 + destCol + 2));
+    int srcSquare = srcRow * 8 + srcCol;
+    int destSquare = destRow * 8 + destCol;
 
-                blackRooks &= ~((uint64_t)1 << (destRow * 8 + 0));
-                blackRooks |= ((uint64_t)1 << (destRow * 8 + 3));
+    // Get the piece at the source position
+    PieceType pieceTypeSrc = squareType[srcSquare];
+    PieceColor pieceColorSrc = squareColor[srcSquare];
+    // Get the piece at the destination position
+    PieceType pieceTypeDest = squareType[destSquare];
+    PieceColor pieceColorDest = squareColor[destSquare];
+
+    // Record what we need to take the move back
+    UndoInfo undo;
+    undo.srcSquare = (int8_t)srcSquare;
+    undo.destSquare = (int8_t)destSquare;
+    undo.movedPiece = pieceTypeSrc;
+    undo.capturedPiece = PieceType::EMPTY;
+    undo.castling = false;
+    undo.enPassant = false;
+    undo.enPassantSquare = (int8_t)enPassantSquare;
+    undo.movedSquares = movedSquares;
+    undo.hashKey = hashKey;
+    undo.halfmoveClock = (int16_t)halfmoveClock;
+    undo.attackMaps[0] = attackMaps[0];
+    undo.attackMaps[1] = attackMaps[1];
+    undo.checkers = checkers;
+
+    // The fifty-move counter restarts on captures and pawn moves
+    halfmoveClock++;
+    if (pieceTypeSrc == PieceType::PAWN || (pieceColorDest != PieceColor::EMPTY && pieceColorDest != pieceColorSrc)) {
+        halfmoveClock = 0;
+    }
+    if (pieceColorSrc == PieceColor::BLACK) {
+        fullmoveNumber++;
+    }
 
-                blackKing &= ~((uint64_t)1 << (0 * 8 + 7));
-            }
+    int previousCastlingRights = getCastlingRights();
+
+    // En passant is only available right after the double push
+    int previousEnPassantSquare = enPassantSquare;
+    enPassantSquare = -1;
+
+    // Mark both source and destination squares as having a piece moved
+    movedSquares |= ((uint64_t)1 << srcSquare) | ((uint64_t)1 << destSquare);
+
+    //HANDLE THE CASTLING MOVE (the king is moved onto its own rook)
+    if (pieceTypeSrc == PieceType::KING && pieceTypeDest == PieceType::ROOK && pieceColorDest == pieceColorSrc) {
+        // Kingside castling puts the king on the g-file and the rook on the f-file,
+        // queenside castling puts the king on the c-file and the rook on the d-file
+        bool kingSide = (destCol == 7);
+        LOG_TRACE(BOARD, "%s %s castling (king col %d, rook col %d)", pieceColorSrc == PieceColor::WHITE ? "White" : "Black",
+            kingSide ? "kingside" : "queenside", srcCol, destCol);
+
+        int kingDestCol = kingSide ? 6 : 2;
+        int rookDestCol = kingSide ? 5 : 3;
+
+        clearSquare(srcSquare);
+        clearSquare(destSquare);
+        addPiece(destRow * 8 + kingDestCol, PieceType::KING, pieceColorSrc);
+        addPiece(destRow * 8 + rookDestCol, PieceType::ROOK, pieceColorSrc);
+
+        movedSquares |= ((uint64_t)1 << (destRow * 8 + kingDestCol)) | ((uint64_t)1 << (destRow * 8 + rookDestCol));
+
+        undo.castling = true;
+        undoStack.push_back(undo);
+        finishMove(previousEnPassantSquare, previousCastlingRights);
+        return;
+    }
+
+    if (pieceColorDest != PieceColor::EMPTY) {
+        undo.capturedPiece = pieceTypeDest;
+    }
 
+    if (pieceTypeSrc == PieceType::PAWN) {
+        // A pawn moving diagonally onto the en passant square captures the pawn beside it
+        if (destSquare == previousEnPassantSquare && srcCol != destCol) {
+            clearSquare(srcRow * 8 + destCol);
+            undo.capturedPiece = PieceType::PAWN;
+            undo.enPassant = true;
         }
+        // A double push leaves the skipped square open to en passant
+        else if (destRow - srcRow == 2 || srcRow - destRow == 2) {
+            enPassantSquare = (srcRow + destRow) / 2 * 8 + srcCol;
+        }
+    }
 
+    // Clear the piece from the source square, and the captured piece (if any) from the destination square
+    clearSquare(srcSquare);
+    clearSquare(destSquare);
+
+    // Set the piece at the destination square, promoting pawns that reach the last row
+    PieceType placedType = pieceTypeSrc;
+    int lastRow = (pieceColorSrc == PieceColor::WHITE) ? 0 : 7;
+    if (pieceTypeSrc == PieceType::PAWN && destRow == lastRow && promotionPiece != PieceType::EMPTY) {
+        placedType = promotionPiece;
     }
-    whiteKing &= ~((uint64_t)1 << (0 * 8));
-    blackKing &= ~((uint64_t)1 << (7 * 8));
-    whiteKing &= ~((uint64_t)1 << (7 * 8 + 7));
-    blackKing &= ~((uint64_t)1 << (0 * 8 + 7));
-    whiteKing &= ~((uint64_t)1 << (7 * 8));
-    blackKing &= ~((uint64_t)1 << (0 * 8 ));
-    whiteKing &= ~((uint64_t)1 << (7 * 8 + 7));
-    blackKing &= ~((uint64_t)1 << (0 * 8 + 7));
+    addPiece(destSquare, placedType, pieceColorSrc);
 
-    //  HANDLE THE CASTLING MOVE
+    undoStack.push_back(undo);
+    finishMove(previousEnPassantSquare, previousCastlingRights);
+}
 
-    // Mark both source and destination squares as having a piece moved
-    pieceMoved[srcRow][srcCol] = true;
-    pieceMoved[destRow][destCol] = true;
-
-    // Calculate the bit positions of the source and destination squares
-    int srcPosition = srcRow * 8 + srcCol;
-    int destPosition = destRow * 8 + destCol;
-
-    // Update the appropriate bitboard to reflect the move
-    uint64_t srcBitboard = (uint64_t)1 << srcPosition;
-    uint64_t destBitboard = (uint64_t)1 << destPosition;
-
-    // Clear the piece from the source square
-    switch (pieceColorSrc) {
-    case PieceColor::WHITE:
-        switch (pieceTypeSrc) {
-        case PieceType::PAWN: whitePawns &= ~srcBitboard; break;
-        case PieceType::ROOK: whiteRooks &= ~srcBitboard; break;
-        case PieceType::KNIGHT: whiteKnights &= ~srcBitboard; break;
-        case PieceType::BISHOP: whiteBishops &= ~srcBitboard; break;
-        case PieceType::QUEEN: whiteQueens &= ~srcBitboard; break;
-        case PieceType::KING: whiteKing &= ~srcBitboard; break;
-        default: break;
-        }
-        break;
-    case PieceColor::BLACK:
-        switch (pieceTypeSrc) {
-        case PieceType::PAWN: blackPawns &= ~srcBitboard; break;
-        case PieceType::ROOK: blackRooks &= ~srcBitboard; break;
-        case PieceType::KNIGHT: blackKnights &= ~srcBitboard; break;
-        case PieceType::BISHOP: blackBishops &= ~srcBitboard; break;
-        case PieceType::QUEEN: blackQueens &= ~srcBitboard; break;
-        case PieceType::KING: blackKing &= ~srcBitboard; break;
-        default: break;
-        }
-        break;
-    default: break;
-    }
-
-    // If the move is a capture, remove the captured piece from the board
-    if (getPieceType(destRow, destCol) != PieceType::EMPTY) {
-        PieceColor capturedPieceColor = getPieceColor(destRow, destCol);
-
-        // Calculate the bit position of the captured piece
-        int capturedPiecePosition = destRow * 8 + destCol;
-        uint64_t capturedPieceBitboard = (uint64_t)1 << capturedPiecePosition;
-
-        // Clear the captured piece from the appropriate bitboard
-        switch (capturedPieceColor) {
-        case PieceColor::WHITE:
-            whitePawns &= ~capturedPieceBitboard;
-            whiteRooks &= ~capturedPieceBitboard;
-            whiteKnights &= ~capturedPieceBitboard;
-            whiteBishops &= ~capturedPieceBitboard;
-            whiteQueens &= ~capturedPieceBitboard;
-            whiteKing &= ~capturedPieceBitboard;
-            break;
-        case PieceColor::BLACK:
-            blackPawns &= ~capturedPieceBitboard;
-            blackRooks &= ~capturedPieceBitboard;
-            blackKnights &= ~capturedPieceBitboard;
-            blackBishops &= ~capturedPieceBitboard;
-            blackQueens &= ~capturedPieceBitboard;
-            blackKing &= ~capturedPieceBitboard;
-            break;
-        default: break;
-        }
-    }
-
-    // Set the piece at the destination square
-    switch (pieceColorSrc) {
-    case PieceColor::WHITE:
-        switch (pieceTypeSrc) {
-        case PieceType::PAWN:
-            if (destRow == 0 && promotionPiece != PieceType::EMPTY) {
-                switch (promotionPiece) {
-                case PieceType::ROOK: whiteRooks |= destBitboard; break;
-                case PieceType::KNIGHT: whiteKnights |= destBitboard; break;
-                case PieceType::BISHOP: whiteBishops |= destBitboard; break;
-                case PieceType::QUEEN: whiteQueens |= destBitboard; break;
-                default: break;
-                }
-            }
-            else {
-                whitePawns |= destBitboard;
-            }
-            break;
-        case PieceType::ROOK: whiteRooks |= destBitboard; break;
-        case PieceType::KNIGHT: whiteKnights |= destBitboard; break;
-        case PieceType::BISHOP: whiteBishops |= destBitboard; break;
-        case PieceType::QUEEN: whiteQueens |= destBitboard; break;
-        case PieceType::KING: whiteKing |= destBitboard; break;
-        default: break;
-        }
-        break;
-    case PieceColor::BLACK:
-        switch (pieceTypeSrc) {
-        case PieceType::PAWN:
-            if (destRow == 7 && promotionPiece != PieceType::EMPTY) {
-                switch (promotionPiece) {
-                case PieceType::ROOK: blackRooks |= destBitboard; break;
-                case PieceType::KNIGHT: blackKnights |= destBitboard; break;
-                case PieceType::BISHOP: blackBishops |= destBitboard; break;
-                case PieceType::QUEEN: blackQueens |= destBitboard; break;
-                default: break;
-                }
-            }
-            else {
-                blackPawns |= destBitboard;
-            }
-            break;
-        case PieceType::ROOK: blackRooks |= destBitboard; break;
-        case PieceType::KNIGHT: blackKnights |= destBitboard; break;
-        case PieceType::BISHOP: blackBishops |= destBitboard; break;
-        case PieceType::QUEEN: blackQueens |= destBitboard; break;
-        case PieceType::KING: blackKing |= destBitboard; break;
-        default: break;
+// Take back the last move made with makeMove
+void Board::unmakeMove() {
+    if (undoStack.empty()) {
+        return;
+    }
+
+    const UndoInfo& undo = undoStack.back();
+    int srcSquare = undo.srcSquare;
+    int destSquare = undo.destSquare;
+    int destRow = destSquare / 8;
+
+    if (undo.castling) {
+        // The king and rook went to the g/f files (kingside) or the c/d files (queenside)
+        bool kingSide = (destSquare % 8 == 7);
+        PieceColor color = squareColor[destRow * 8 + (kingSide ? 6 : 2)];
+        clearSquare(destRow * 8 + (kingSide ? 6 : 2));
+        clearSquare(destRow * 8 + (kingSide ? 5 : 3));
+        addPiece(srcSquare, PieceType::KING, color);
+        addPiece(destSquare, PieceType::ROOK, color);
+    }
+    else {
+        PieceColor color = squareColor[destSquare];
+        clearSquare(destSquare);
+        addPiece(srcSquare, undo.movedPiece, color);
+        if (undo.enPassant) {
+            addPiece(srcSquare - srcSquare % 8 + destSquare % 8, PieceType::PAWN, getOppositeColor(color));
+        }
+        else if (undo.capturedPiece != PieceType::EMPTY) {
+            addPiece(destSquare, undo.capturedPiece, getOppositeColor(color));
         }
-        break;
-    default: break;
     }
 
-    return true;
+    movedSquares = undo.movedSquares;
+    enPassantSquare = undo.enPassantSquare;
+    sideToMove = getOppositeColor(sideToMove);
+    hashKey = undo.hashKey;
+    halfmoveClock = undo.halfmoveClock;
+    attackMaps[0] = undo.attackMaps[0];
+    attackMaps[1] = undo.attackMaps[1];
+    checkers = undo.checkers;
+    if (squareColor[srcSquare] == PieceColor::BLACK) {
+        fullmoveNumber--;
+    }
+    undoStack.pop_back();
+
+    assert(hashKey == computeHashKey());
+    assert(attackMaps[0] == computeAttacks(PieceColor::WHITE) && attackMaps[1] == computeAttacks(PieceColor::BLACK));
+}
+
+
+
+void Board::makeNullMove() {
+    assert(checkers == 0);
+
+    UndoInfo undo;
+    undo.srcSquare = -1;
+    undo.destSquare = -1;
+    undo.movedPiece = PieceType::EMPTY;
+    undo.capturedPiece = PieceType::EMPTY;
+    undo.castling = false;
+    undo.enPassant = false;
+    undo.enPassantSquare = (int8_t)enPassantSquare;
+    undo.movedSquares = movedSquares;
+    undo.hashKey = hashKey;
+    undo.halfmoveClock = (int16_t)halfmoveClock;
+    undo.attackMaps[0] = attackMaps[0];
+    undo.attackMaps[1] = attackMaps[1];
+    undo.checkers = checkers;
+    undoStack.push_back(undo);
+
+    halfmoveClock++;
+    if (enPassantSquare != -1) {
+        hashKey ^= zobristEnPassant[enPassantSquare % 8];
+        enPassantSquare = -1;
+    }
+    sideToMove = getOppositeColor(sideToMove);
+    hashKey ^= zobristSide;
+
+    // Nothing moved, so the attack maps stay. The side now to move can't be in check,
+    // the other side would have been able to capture its king
+    checkers = 0;
+
+    assert(hashKey == computeHashKey());
 }
 
+void Board::unmakeNullMove() {
+    const UndoInfo& undo = undoStack.back();
+    assert(undo.srcSquare == -1);
 
+    enPassantSquare = undo.enPassantSquare;
+    sideToMove = getOppositeColor(sideToMove);
+    hashKey = undo.hashKey;
+    halfmoveClock = undo.halfmoveClock;
+    checkers = undo.checkers;
+    undoStack.pop_back();
+}
 
 void Board::printBoard() const {
     // Create a character array to represent the chessboard
@@ -464,68 +828,39 @@ void Board::printBoard() const {
 
 
 PieceColor Board::getPieceColor(int row, int col) const {
-    uint64_t squareBit = (uint64_t)1 << (row * 8 + col); // 8 is the BOARD_SIZE
-
-    if (whitePawns & squareBit || whiteKnights & squareBit || whiteBishops & squareBit ||
-        whiteRooks & squareBit || whiteQueens & squareBit || whiteKing & squareBit) {
-        return PieceColor::WHITE;
-    }
-    else if (blackPawns & squareBit || blackKnights & squareBit || blackBishops & squareBit ||
-        blackRooks & squareBit || blackQueens & squareBit || blackKing & squareBit) {
-        return PieceColor::BLACK;
-    }
-
-    return PieceColor::EMPTY; // No piece on the square
+    return squareColor[row * 8 + col];
 }
 
 PieceType Board::getPieceType(int row, int col) const {
-    uint64_t squareBit = (uint64_t)1 << (row * 8 + col);
+    return squareType[row * 8 + col];
+}
 
-    if (whitePawns & squareBit) {
-        return PieceType::PAWN;
-    }
-    else if (whiteKnights & squareBit) {
-        return PieceType::KNIGHT;
-    }
-    else if (whiteBishops & squareBit) {
-        return PieceType::BISHOP;
-    }
-    else if (whiteRooks & squareBit) {
-        return PieceType::ROOK;
-    }
-    else if (whiteQueens & squareBit) {
-        return PieceType::QUEEN;
-    }
-    else if (whiteKing & squareBit) {
-        return PieceType::KING;
-    }
-    else if (blackPawns & squareBit) {
-        return PieceType::PAWN;
-    }
-    else if (blackKnights & squareBit) {
-        return PieceType::KNIGHT;
-    }
-    else if (blackBishops & squareBit) {
-        return PieceType::BISHOP;
-    }
-    else if (blackRooks & squareBit) {
-        return PieceType::ROOK;
+uint64_t Board::getPieces(PieceType type, PieceColor color) const {
+    if (type == PieceType::EMPTY || color == PieceColor::EMPTY) {
+        return 0;
     }
-    else if (blackQueens & squareBit) {
-        return PieceType::QUEEN;
+    return pieceBitboards[(int)color][(int)type];
+}
+
+uint64_t Board::getOccupancy(PieceColor color) const {
+    if (color == PieceColor::WHITE) {
+        return whiteOccupancy;
     }
-    else if (blackKing & squareBit) {
-        return PieceType::KING;
+    else if (color == PieceColor::BLACK) {
+        return blackOccupancy;
     }
+    return 0;
+}
 
-    return PieceType::EMPTY; // No piece on the square
+uint64_t Board::getOccupancy() const {
+    return allOccupancy;
 }
 
 bool Board::isEmpty(int row, int col) const {
     if (!isValidPosition(row, col)) {
         return false;
     }
-    return (getPieceType(row, col) == PieceType::EMPTY && getPieceColor(row, col) == PieceColor::EMPTY);
+    return squareType[row * 8 + col] == PieceType::EMPTY;
 }
 
 bool Board::isValidPosition(int row, int col) const {
@@ -533,27 +868,12 @@ bool Board::isValidPosition(int row, int col) const {
 }
 
 void Board::removePiece(int row, int col, PieceColor color) {
-    uint64_t squareBit = (uint64_t)1 << (row * 8 + col);
-
-    switch (color) {
-    case PieceColor::WHITE:
-        whitePawns &= ~squareBit;
-        whiteRooks &= ~squareBit;
-        whiteKnights &= ~squareBit;
-        whiteBishops &= ~squareBit;
-        whiteQueens &= ~squareBit;
-        whiteKing &= ~squareBit;
-        break;
-    case PieceColor::BLACK:
-        blackPawns &= ~squareBit;
-        blackRooks &= ~squareBit;
-        blackKnights &= ~squareBit;
-        blackBishops &= ~squareBit;
-        blackQueens &= ~squareBit;
-        blackKing &= ~squareBit;
-        break;
-    default:
-        break;
+    int square = row * 8 + col;
+
+    // Only remove the piece if it belongs to the given color
+    if (color != PieceColor::EMPTY && squareColor[square] == color) {
+        clearSquare(square);
+        updateAttackMaps();
     }
 }
 
@@ -570,45 +890,33 @@ bool Board::isGameOver(PieceColor color) const {
 
     // Check if either king is captured
     if (isEmpty(whiteKingRow, whiteKingCol)) {
-        std::cout << "Black wins by capturing the white king!" << std::endl;
+        LOG_INFO(BOARD, "Black wins by capturing the white king!");
         return true;
     }
     if (isEmpty(blackKingRow, blackKingCol)) {
-        std::cout << "White wins by capturing the black king!" << std::endl;
+        LOG_INFO(BOARD, "White wins by capturing the black king!");
         return true;
     }
 
     // Check for checkmate or stalemate
     bool isCurrentPlayerInCheck = isInCheck(color);
 
-    // Generate all possible moves for the current player
-    std::vector<Move> allMoves = generateAllMoves(*this, color);
-
-    bool hasValidMoves = false;
-
-    // Check if the current player has any valid moves
-    for (const Move& move : allMoves) {
-        Board tempBoard = *this;
-        tempBoard.makeMove(move.srcRow, move.srcCol, move.destRow, move.destCol);
-        if (!tempBoard.isInCheck(color)) {
-            hasValidMoves = true;
-            break;
-        }
-    }
+    // Check if the current player has any legal moves
+    bool hasValidMoves = hasAnyLegalMove(*this, color);
 
     if (isCurrentPlayerInCheck && !hasValidMoves) {
         if (color == PieceColor::WHITE) {
-            std::cout << "Black wins by checkmate!" << std::endl;
+            LOG_INFO(BOARD, "Black wins by checkmate!");
             return true;
         }
         else {
-            std::cout << "White wins by checkmate!" << std::endl;
+            LOG_INFO(BOARD, "White wins by checkmate!");
             return true;
         }
         return true;
     }
     else if (!isCurrentPlayerInCheck && !hasValidMoves) {
-        std::cout << "It's a stalemate!" << std::endl;
+        LOG_INFO(BOARD, "It's a stalemate!");
         return true;
     }
 
@@ -620,38 +928,29 @@ bool Board::isGameOver(PieceColor color) const {
 
 
 bool Board::isInCheck(PieceColor color) const {
-    // Get the position of the current player's king
-    int kingRow = -1;
-    int kingCol = -1;
-
-    for (int row = 0; row < BOARD_SIZE; ++row) {
-        for (int col = 0; col < BOARD_SIZE; ++col) {
-            if (getPieceType(row, col) == PieceType::KING && getPieceColor(row, col) == color) {
-                kingRow = row;
-                kingCol = col;
-                break;
-            }
-        }
+    // The side to move has its checkers cached, the other side only needs its king tested against the attack map
+    if (color == sideToMove) {
+        return checkers != 0;
     }
-
-    if (kingRow == -1 || kingCol == -1) {
-        // King not found (this should not happen in a valid chess position)
+    if (color == PieceColor::EMPTY) {
         return false;
     }
+    return (attackMaps[(int)getOppositeColor(color)] & pieceBitboards[(int)color][(int)PieceType::KING]) != 0;
+}
 
-    // Check if any opponent's piece can attack the current player's king
-    PieceColor opponentColor = getOppositeColor(color);
-    for (int row = 0; row < BOARD_SIZE; ++row) {
-        for (int col = 0; col < BOARD_SIZE; ++col) {
-            if (getPieceColor(row, col) == opponentColor) {
-                if (isValidMove(row, col, kingRow, kingCol)) {
-                    return true;
-                }
-            }
-        }
-    }
-
-    return false;
+uint64_t Board::attackersTo(int square, uint64_t occupancy) const {
+    const uint64_t (&white)[6] = pieceBitboards[(int)PieceColor::WHITE];
+    const uint64_t (&black)[6] = pieceBitboards[(int)PieceColor::BLACK];
+    uint64_t diagonal = white[(int)PieceType::BISHOP] | white[(int)PieceType::QUEEN] | black[(int)PieceType::BISHOP] | black[(int)PieceType::QUEEN];
+    uint64_t straight = white[(int)PieceType::ROOK] | white[(int)PieceType::QUEEN] | black[(int)PieceType::ROOK] | black[(int)PieceType::QUEEN];
+
+    // A pawn attacks this square if a pawn of the other color standing here would attack it
+    return (pawnAttacks(PieceColor::BLACK, square) & white[(int)PieceType::PAWN]) |
+        (pawnAttacks(PieceColor::WHITE, square) & black[(int)PieceType::PAWN]) |
+        (knightAttacks(square) & (white[(int)PieceType::KNIGHT] | black[(int)PieceType::KNIGHT])) |
+        (kingAttacks(square) & (white[(int)PieceType::KING] | black[(int)PieceType::KING])) |
+        (bishopAttacks(square, occupancy) & diagonal) |
+        (rookAttacks(square, occupancy) & straight);
 }
 
 
@@ -660,21 +959,17 @@ PieceColor Board::getOppositeColor(PieceColor color) const {
 }
 
 void Board::findKing(PieceType kingType, PieceColor kingColor, int& kingRow, int& kingCol) const {
-    uint64_t kingBitboard = kingColor == PieceColor::WHITE ? whiteKing : blackKing;
-
-    // Iterate over the set bits in the kingBitboard to find the position of the king
-    for (int position = 0; position < BOARD_SIZE * BOARD_SIZE; ++position) {
-        uint64_t squareBit = (uint64_t)1 << position;
-        if (kingBitboard & squareBit) {
-            kingRow = position / BOARD_SIZE;
-            kingCol = position % BOARD_SIZE;
-            return;
-        }
+    uint64_t kingBitboard = getPieces(PieceType::KING, kingColor);
+    if (!kingBitboard) {
+        // If the king is not found, set kingRow and kingCol to invalid values
+        kingRow = -1;
+        kingCol = -1;
+        return;
     }
 
-    // If the king is not found, set kingRow and kingCol to invalid values
-    kingRow = -1;
-    kingCol = -1;
+    int square = bitScanForward(kingBitboard);
+    kingRow = square / 8;
+    kingCol = square % 8;
 }
 
 
@@ -684,17 +979,8 @@ bool Board::isCheckmate(PieceColor color) const {
         return false;
     }
 
-    std::vector<Move> allMoves = generateAllMoves(*this, color);
-
-    //Check if any of the valid moves can get the player out of check
-    for (const Move& move : allMoves) {
-        Board tempBoard = *this;
-        tempBoard.makeMove(move.srcRow, move.srcCol, move.destRow, move.destCol);
-        if (!tempBoard.isInCheck(color)) {
-            return false; //Player can escape check, so it's not checkmate
-        }
-    }
-    return true;
+    //Checkmate if no legal move gets the player out of check
+    return !hasAnyLegalMove(*this, color);
 }
 
 bool Board::isCastlingValid(int srcRow, int srcCol, int destRow, int destCol) const {
@@ -748,7 +1034,7 @@ bool Board::isCastlingValid(int srcRow, int srcCol, int destRow, int destCol) co
 }
 
 bool Board::hasPieceMoved(int row, int col) const {
-    return pieceMoved[row][col];
+    return (movedSquares >> (row * 8 + col)) & 1;
 }
 
 void Board::printHasPieceMoved() {
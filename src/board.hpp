@@ -2,17 +2,56 @@
 #define BOARD_HPP
 
 #include <cstdint>
-#include "piece.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include "types.hpp"
 #include "move.hpp"
 
+// Everything makeMove changes that can't be recovered from the board afterwards,
+// pushed for every move so unmakeMove can restore the previous position in place
+struct UndoInfo {
+    int8_t srcSquare;
+    int8_t destSquare;
+    PieceType movedPiece;    // Type of the moving piece before the move (a pawn for promotions)
+    PieceType capturedPiece; // EMPTY for quiet moves and castling
+    bool castling;
+    bool enPassant;          // The captured pawn was beside the destination square, not on it
+    int8_t enPassantSquare;  // Previous en passant square
+    uint64_t movedSquares;   // Previous "piece has moved" squares, which hold the castling rights
+    uint64_t hashKey;        // Zobrist key before the move
+    int16_t halfmoveClock;   // Previous fifty-move counter
+    uint64_t attackMaps[2];  // Previous attack maps, cheaper to copy back than to recompute
+    uint64_t checkers;       // Previous checkers
+};
+
 class Board {
 public:
     const int BOARD_SIZE = 8;
 
+    static constexpr const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
     Board();
+    // Sets up the standard starting position
     void initializeFromFEN();
+    // Loads any position given in FEN. The move clocks may be left out. Returns false and leaves the
+    // board unchanged if the FEN is invalid, pointing error (if given) at a description of the problem.
+    // Never allocates, so it is cheap enough to load large position files
+    bool setFromFEN(std::string_view fen, std::string_view* error = nullptr);
+    std::string toFEN() const;
     bool isValidMove(int srcRow, int srcCol, int destRow, int destCol) const;
+    // Checks the move is pseudo-legal before making it, for moves coming from outside the engine
     bool makeMove(int srcRow, int srcCol, int destRow, int destCol, PieceType promotionPiece = PieceType::EMPTY);
+    // Makes the move without any checks. Only for moves known to be legal, like generated ones
+    void makeMove(const Move& move);
+    // Whether the piece on the source square can make the move, ignoring pins and checks.
+    // Constant time: a few attack table lookups, no move generation
+    bool isPseudoLegal(const Move& move) const;
+    void unmakeMove();
+    // Passes the turn without moving, for null-move pruning. Not allowed while in check, and must be
+    // taken back with unmakeNullMove before any other unmake
+    void makeNullMove();
+    void unmakeNullMove();
     void printBoard() const;
     bool isValidPosition(int row, int col) const;
     bool isEmpty(int row, int col) const;
@@ -27,33 +66,87 @@ public:
     PieceType getPieceType(int row, int col) const;
     PieceColor getPieceColor(int row, int col) const;
 
+    uint64_t getPieces(PieceType type, PieceColor color) const;
+    uint64_t getOccupancy(PieceColor color) const;
+    uint64_t getOccupancy() const;
+
     PieceColor getAIPlayer() const { return aiPlayer; }
     PieceColor getRealPlayer() const { return realPlayer; }
     void setAIPlayer(PieceColor color) { aiPlayer = color; }
     void setRealPlayer(PieceColor color) { realPlayer = color; }
 
+    // Square a pawn skipped with a double push on the last move (row * 8 + col), or -1
+    int getEnPassantSquare() const { return enPassantSquare; }
+
+    // Color whose turn it is, flipped by every makeMove and unmakeMove
+    PieceColor getSideToMove() const { return sideToMove; }
+
+    // Half moves since the last capture or pawn move, and the full move number from the FEN
+    int getHalfmoveClock() const { return halfmoveClock; }
+    int getFullmoveNumber() const { return fullmoveNumber; }
+
+    // Zobrist key of the position, updated incrementally as pieces are added and removed
+    uint64_t getHashKey() const { return hashKey; }
+    // Builds the key from scratch, used to check the incremental key
+    uint64_t computeHashKey() const;
+
+    // Every square attacked by the given color, kept up to date by makeMove and unmakeMove.
+    // Squares behind a blocker are not included, even if the blocker is the other side's king
+    uint64_t getAttacks(PieceColor color) const { return attackMaps[(int)color]; }
+
+    // Pieces of either color attacking the square, with sliders blocked by the given occupancy
+    uint64_t attackersTo(int square, uint64_t occupancy) const;
+
+    // Enemy pieces giving check to the side to move, computed once per move
+    uint64_t getCheckers() const { return checkers; }
+
+    // Castling rights still available (bit 0 white kingside, 1 white queenside, 2 black kingside, 3 black queenside)
+    int getCastlingRights() const;
+
     void printHasPieceMoved();
     bool hasPieceMoved(int row, int col) const;
 
 private:
 
-    uint64_t whitePawns;
-    uint64_t whiteKnights;
-    uint64_t whiteBishops;
-    uint64_t whiteRooks;
-    uint64_t whiteQueens;
-    uint64_t whiteKing;
-    uint64_t blackPawns;
-    uint64_t blackKnights;
-    uint64_t blackBishops;
-    uint64_t blackRooks;
-    uint64_t blackQueens;
-    uint64_t blackKing;
+    // Bitboards for every piece type, indexed [color][type] with the PieceColor and PieceType values
+    uint64_t pieceBitboards[2][6];
+
+    // Aggregated occupancy, kept in sync with the piece bitboards
+    uint64_t whiteOccupancy;
+    uint64_t blackOccupancy;
+    uint64_t allOccupancy;
+
+    // Piece on each square (row * 8 + col), so square lookups don't have to test every bitboard
+    PieceType squareType[64];
+    PieceColor squareColor[64];
 
     PieceColor aiPlayer;
     PieceColor realPlayer;
 
-    bool pieceMoved[8][8];
+    int enPassantSquare;
+
+    // Squares a piece has moved from or to (bit row * 8 + col), used for castling rights
+    uint64_t movedSquares;
+
+    PieceColor sideToMove;
+    uint64_t hashKey;
+
+    int halfmoveClock;
+    int fullmoveNumber;
+
+    // Squares attacked by each side, indexed with the PieceColor values
+    uint64_t attackMaps[2];
+    uint64_t checkers;
+
+    // One entry per move made on this board, popped by unmakeMove
+    std::vector<UndoInfo> undoStack;
+
+    void clearBoard();
+    void addPiece(int square, PieceType type, PieceColor color);
+    void clearSquare(int square);
+    void finishMove(int previousEnPassantSquare, int previousCastlingRights);
+    uint64_t computeAttacks(PieceColor color) const;
+    void updateAttackMaps();
 };
 
 #endif //BOARD_HPP
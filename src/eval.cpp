@@ -1,5 +1,6 @@
 #include "eval.hpp"
 #include "board.hpp"
+#include "attacks.hpp"
 
 const int PAWN_VALUE = 100;
 const int KNIGHT_VALUE = 300;
@@ -7,6 +8,11 @@ const int BISHOP_VALUE = 300;
 const int ROOK_VALUE = 500;
 const int QUEEN_VALUE = 900;
 
+// Bonus per square a side attacks that isn't occupied by its own pieces
+const int MOBILITY_WEIGHT = 2;
+// Penalty per square around a king (and the king's own square) the other side attacks
+const int KING_ZONE_ATTACK_PENALTY = 8;
+
 const int PIECE_POSITIONS[8][8] = {
     {-20, -10, -10, -10, -10, -10, -10, -20},
     {-10,  0,  0,  0,  0,  0,  0, -10},
@@ -18,6 +24,23 @@ const int PIECE_POSITIONS[8][8] = {
     {-20, -10, -10, -10, -10, -10, -10, -20}
 };
 
+int Evaluation::pieceValue(PieceType pieceType) {
+    switch (pieceType) {
+    case PieceType::PAWN:
+        return PAWN_VALUE;
+    case PieceType::KNIGHT:
+        return KNIGHT_VALUE;
+    case PieceType::BISHOP:
+        return BISHOP_VALUE;
+    case PieceType::ROOK:
+        return ROOK_VALUE;
+    case PieceType::QUEEN:
+        return QUEEN_VALUE;
+    default:
+        return 0;
+    }
+}
+
 int Evaluation::evaluate(const Board& board, PieceColor color) {
     int whiteScore = 0;
     int blackScore = 0;
@@ -59,7 +82,24 @@ int Evaluation::evaluate(const Board& board, PieceColor color) {
         }
     }
 
-    color = board.getAIPlayer();
+    // Mobility and king safety, read straight from the attack maps the board keeps up to date
+    uint64_t whiteAttacks = board.getAttacks(PieceColor::WHITE);
+    uint64_t blackAttacks = board.getAttacks(PieceColor::BLACK);
+
+    whiteScore += MOBILITY_WEIGHT * popCount(whiteAttacks & ~board.getOccupancy(PieceColor::WHITE));
+    blackScore += MOBILITY_WEIGHT * popCount(blackAttacks & ~board.getOccupancy(PieceColor::BLACK));
+
+    uint64_t whiteKing = board.getPieces(PieceType::KING, PieceColor::WHITE);
+    uint64_t blackKing = board.getPieces(PieceType::KING, PieceColor::BLACK);
+    if (whiteKing) {
+        uint64_t zone = kingAttacks(bitScanForward(whiteKing)) | whiteKing;
+        whiteScore -= KING_ZONE_ATTACK_PENALTY * popCount(zone & blackAttacks);
+    }
+    if (blackKing) {
+        uint64_t zone = kingAttacks(bitScanForward(blackKing)) | blackKing;
+        blackScore -= KING_ZONE_ATTACK_PENALTY * popCount(zone & whiteAttacks);
+    }
 
+    // Positive when the position favours color
     return (color == PieceColor::WHITE) ? whiteScore - blackScore : blackScore - whiteScore;
 }
@@ -6,6 +6,8 @@
 class Evaluation {
 public:
 	static int evaluate(const Board& board, PieceColor color);
+	// Material value of a piece type in centipawns (the king and empty squares are worth 0)
+	static int pieceValue(PieceType pieceType);
 };
 
 #endif // EVAL_HPP
@@ -6,7 +6,11 @@
 #include <string>
 #include <iostream>
 #include "search.hpp"
+#include "ai.hpp"
+#include "log.hpp"
 #include <map>
+#include <thread>
+#include <algorithm>
 #include <SDL_events.h>
 #include <SDL_keyboard.h>
 #include "movegen.hpp"
@@ -33,6 +37,9 @@ GUI::GUI() : board() {
     //Initialize promotion piece types
     promotionPieceType[PieceColor::WHITE] = PieceType::QUEEN;
     promotionPieceType[PieceColor::BLACK] = PieceType::QUEEN;
+
+    // Let the AI think on every core (hardware_concurrency is 0 when it can't tell)
+    search.setThreads(std::max(1, (int)std::thread::hardware_concurrency()));
 }
 
 GUI::~GUI() {
@@ -94,7 +101,7 @@ void GUI::run() {
     board.setAIPlayer(aiPlayerColor);
 
     // Variable to keep track of the player's turn
-    bool isPlayerTurn = false;
+    bool isPlayerTurn = !AI::isAITurn(board);
 
     // Start the game loop
     while (!quit && !board.isGameOver(realPlayerColor)) {
@@ -126,65 +133,46 @@ void GUI::run() {
 
                             printValidMoves(selectedPieceRow, selectedPieceCol);
 
-                            if (board.getPieceType(selectedPieceRow, selectedPieceCol) == PieceType::KING) {
-                                std::vector<Move> validKingMoves = generateCastlingMoves(board, selectedPieceRow, selectedPieceCol);
+                            if (board.getPieceType(selectedPieceRow, selectedPieceCol) == PieceType::KING &&
+                                LOG_ENABLED(LogLevel::DEBUG, LogCategory::GUI)) {
+                                MoveList validKingMoves;
+                                generateCastlingMoves(board, selectedPieceRow, selectedPieceCol, validKingMoves);
 
-                                std::cout << "Valid moves for the selected king:" << std::endl;
                                 for (const Move& move : validKingMoves) {
-                                    std::cout << "From (" << selectedPieceRow << "," << selectedPieceCol << ") to (" << move.destRow << "," << move.destCol << ")" << std::endl;
+                                    LOG_DEBUG(GUI, "Castling move for the selected king: (%d,%d) to (%d,%d)", selectedPieceRow, selectedPieceCol, move.destRow, move.destCol);
                                 }
 
-                                // Debugging the kingside castling conditions
+                                // Debugging the castling conditions, only for a king on its home square
                                 int kingRow = selectedPieceRow;
                                 int kingCol = selectedPieceCol;
-                                int kingSideRookCol = kingCol + 3;
-                                PieceColor pieceColor = board.getPieceColor(kingRow, kingCol);
-
-                                bool condition1 = !board.hasPieceMoved(kingRow, kingCol);
-                                bool condition2 = !board.hasPieceMoved(kingRow, kingSideRookCol);
-                                bool condition3 = board.isEmpty(kingRow, kingCol + 1);
-                                bool condition4 = board.isEmpty(kingRow, kingCol + 2);
-                                bool condition5 = !isSquareAttacked(board, kingRow, kingCol, getOppositeColor(pieceColor));
-                                bool condition6 = !isSquareAttacked(board, kingRow, kingCol + 1, getOppositeColor(pieceColor));
-                                bool condition7 = !isSquareAttacked(board, kingRow, kingCol + 2, getOppositeColor(pieceColor));
-                                bool condition8 = !isSquareAttacked(board, kingRow, kingCol + 2, getOppositeColor(pieceColor));
-                                bool condition9 = !isSquareAttacked(board, kingRow, kingCol + 1, getOppositeColor(pieceColor));
-
-                                std::cout << "Kingside Castling Conditions:" << std::endl;
-                                std::cout << "Condition 1: " << (condition1 ? "Met" : "Not Met") << std::endl;
-                                std::cout << "Condition 2: " << (condition2 ? "Met" : "Not Met") << std::endl;
-                                std::cout << "Condition 3: " << (condition3 ? "Met" : "Not Met") << std::endl;
-                                std::cout << "Condition 4: " << (condition4 ? "Met" : "Not Met") << std::endl;
-                                std::cout << "Condition 5: " << (condition5 ? "Met" : "Not Met") << std::endl;
-                                std::cout << "Condition 6: " << (condition6 ? "Met" : "Not Met") << std::endl;
-                                std::cout << "Condition 7: " << (condition7 ? "Met" : "Not Met") << std::endl;
-                                std::cout << "Condition 8: " << (condition8 ? "Met" : "Not Met") << std::endl;
-                                std::cout << "Condition 9: " << (condition9 ? "Met" : "Not Met") << std::endl;
-
-                                // Debugging the queenside castling conditions
-                                int queenSideRookCol = kingCol - 4;
-                                bool condition10 = !board.hasPieceMoved(kingRow, kingCol);
-                                bool condition11 = !board.hasPieceMoved(kingRow, queenSideRookCol);
-                                bool condition12 = board.isEmpty(kingRow, kingCol - 1);
-                                bool condition13 = board.isEmpty(kingRow, kingCol - 2);
-                                bool condition14 = board.isEmpty(kingRow, kingCol - 3);
-                                bool condition15 = !isSquareAttacked(board, kingRow, kingCol, getOppositeColor(pieceColor));
-                                bool condition16 = !isSquareAttacked(board, kingRow, kingCol - 1, getOppositeColor(pieceColor));
-                                bool condition17 = !isSquareAttacked(board, kingRow, kingCol - 2, getOppositeColor(pieceColor));
-                                bool condition18 = !isSquareAttacked(board, kingRow, kingCol - 3, getOppositeColor(pieceColor));
-                                bool condition19 = !isSquareAttacked(board, kingRow, kingCol - 4, getOppositeColor(pieceColor));
-
-                                std::cout << "Queenside Castling Conditions:" << std::endl;
-                                std::cout << "Condition 10: " << (condition10 ? "Met" : "Not Met") << std::endl;
-                                std::cout << "Condition 11: " << (condition11 ? "Met" : "Not Met") << std::endl;
-                                std::cout << "Condition 12: " << (condition12 ? "Met" : "Not Met") << std::endl;
-                                std::cout << "Condition 13: " << (condition13 ? "Met" : "Not Met") << std::endl;
-                                std::cout << "Condition 14: " << (condition14 ? "Met" : "Not Met") << std::endl;
-                                std::cout << "Condition 15: " << (condition15 ? "Met" : "Not Met") << std::endl;
-                                std::cout << "Condition 16: " << (condition16 ? "Met" : "Not Met") << std::endl;
-                                std::cout << "Condition 17: " << (condition17 ? "Met" : "Not Met") << std::endl;
-                                std::cout << "Condition 18: " << (condition18 ? "Met" : "Not Met") << std::endl;
-                                std::cout << "Condition 19: " << (condition19 ? "Met" : "Not Met") << std::endl;
+                                if (kingCol == 4) {
+                                    PieceColor enemyColor = getOppositeColor(board.getPieceColor(kingRow, kingCol));
+
+                                    bool kingSide[] = {
+                                        !board.hasPieceMoved(kingRow, kingCol),
+                                        !board.hasPieceMoved(kingRow, 7),
+                                        board.isEmpty(kingRow, 5),
+                                        board.isEmpty(kingRow, 6),
+                                        !isSquareAttacked(board, kingRow, kingCol, enemyColor),
+                                        !isSquareAttacked(board, kingRow, 5, enemyColor),
+                                        !isSquareAttacked(board, kingRow, 6, enemyColor)
+                                    };
+                                    bool queenSide[] = {
+                                        !board.hasPieceMoved(kingRow, kingCol),
+                                        !board.hasPieceMoved(kingRow, 0),
+                                        board.isEmpty(kingRow, 3),
+                                        board.isEmpty(kingRow, 2),
+                                        board.isEmpty(kingRow, 1),
+                                        !isSquareAttacked(board, kingRow, kingCol, enemyColor),
+                                        !isSquareAttacked(board, kingRow, 3, enemyColor),
+                                        !isSquareAttacked(board, kingRow, 2, enemyColor)
+                                    };
+
+                                    LOG_DEBUG(GUI, "Kingside castling conditions (king unmoved, rook unmoved, f/g empty, e/f/g safe): %d %d %d %d %d %d %d",
+                                        kingSide[0], kingSide[1], kingSide[2], kingSide[3], kingSide[4], kingSide[5], kingSide[6]);
+                                    LOG_DEBUG(GUI, "Queenside castling conditions (king unmoved, rook unmoved, d/c/b empty, e/d/c safe): %d %d %d %d %d %d %d %d",
+                                        queenSide[0], queenSide[1], queenSide[2], queenSide[3], queenSide[4], queenSide[5], queenSide[6], queenSide[7]);
+                                }
                             }
 
 
@@ -193,8 +181,7 @@ void GUI::run() {
                     }
                     else {
 
-                        std::cout << "Before move:" << std::endl;
-                        board.printBoard();
+                        LOG_DEBUG(GUI, "Before move: %s", board.toFEN().c_str());
 
                         // Check if the player clicked on the same square again to unselect the piece
                         if (selectedPieceRow == mouseRow && selectedPieceCol == mouseCol) {
@@ -203,15 +190,9 @@ void GUI::run() {
                         else {
                             // Move the selected piece if it is a valid move for the player
                             if (isValidMoveForCurrentPlayer(selectedPieceRow, selectedPieceCol, mouseRow, mouseCol)) {
-                                // Create a temporary copy of the board
-                                Board tempBoard = board;
-
-                                // Make the move on the temporary board
-                                tempBoard.makeMove(selectedPieceRow, selectedPieceCol, mouseRow, mouseCol);
-
-                                // Check if the move leads to the player's own king being in check
+                                // Check that the move doesn't leave the player's own king in check
                                 PieceColor currentPlayerColor = realPlayerColor;
-                                if (!tempBoard.isInCheck(currentPlayerColor)) {
+                                if (isLegalMove(board, Move(selectedPieceRow, selectedPieceCol, mouseRow, mouseCol))) {
                                     //Perform pawn promotion check
                                     if (selectedPieceType == PieceType::PAWN &&
                                         ((currentPlayerColor == PieceColor::WHITE && mouseRow == 0) ||
@@ -233,8 +214,7 @@ void GUI::run() {
 
                                     }
 
-                                    std::cout << "After move:" << std::endl;
-                                    board.printBoard();
+                                    LOG_DEBUG(GUI, "After move: %s", board.toFEN().c_str());
                                    
                                     isPieceSelected = false; // Player's move is complete, deselect the piece
 
@@ -261,18 +241,26 @@ void GUI::run() {
 
         // AI's turn
         if (!isPlayerTurn && !board.isGameOver(realPlayerColor)) {
-            Search search;
+            // The search moves for whichever side is to move, so never hand it the board on the player's turn
+            if (!AI::isAITurn(board)) {
+                LOG_ERROR(GUI, "AI asked to move on the player's turn");
+                isPlayerTurn = true;
+                continue;
+            }
+
+            SearchLimits aiLimits;
+            aiLimits.moveTimeMs = AI_MOVE_TIME_MS;
 
             if (board.isInCheck(aiPlayerColor)) {
                 std::cout << "Check!" << std::endl;
 
                 // Check if the AI's king is in check and try to move it out of check
-                Move aiKingMove = search.alphaBetaSearch(board, 4); // Increase the depth for stronger AI, e.g., 4
+                Move aiKingMove = search.search(board, aiLimits);
 
                 if (board.isValidMove(aiKingMove.srcRow, aiKingMove.srcCol, aiKingMove.destRow, aiKingMove.destCol)) {
                     // Make the AI's valid move
-                    board.makeMove(aiKingMove.srcRow, aiKingMove.srcCol, aiKingMove.destRow, aiKingMove.destCol);
-                    std::cout << "AI moves its king." << std::endl;
+                    board.makeMove(aiKingMove.srcRow, aiKingMove.srcCol, aiKingMove.destRow, aiKingMove.destCol, aiKingMove.promotionPiece);
+                    LOG_DEBUG(GUI, "AI moves its king.");
                 }
                 else {
                     // Handle invalid AI move here (optional)
@@ -280,24 +268,17 @@ void GUI::run() {
                 }
             }
             else {
-                Move bestMove = search.alphaBetaSearch(board, 2); // Increase the depth for stronger AI, e.g., 4
+                Move bestMove = search.search(board, aiLimits);
 
                 if (board.isValidMove(bestMove.srcRow, bestMove.srcCol, bestMove.destRow, bestMove.destCol)) {
                     // Make the AI's valid move
-                    board.makeMove(bestMove.srcRow, bestMove.srcCol, bestMove.destRow, bestMove.destCol);
+                    board.makeMove(bestMove.srcRow, bestMove.srcCol, bestMove.destRow, bestMove.destCol, bestMove.promotionPiece);
 
-                    std::cout << "AI Move:" << std::endl;
-                    board.printBoard();
+                    LOG_DEBUG(GUI, "AI move: %s", board.toFEN().c_str());
 
                     // Check if the AI's move resulted in a checkmate
                     if (board.isCheckmate(aiPlayerColor)) {
-                        std::cout << "Checkmate! ";
-                        if (aiPlayerColor == PieceColor::WHITE) {
-                            std::cout << "Black wins!" << std::endl;
-                        }
-                        else {
-                            std::cout << "White wins!" << std::endl;
-                        }
+                        std::cout << "Checkmate! " << (aiPlayerColor == PieceColor::WHITE ? "Black" : "White") << " wins!" << std::endl;
                         isPlayerTurn = true; // End the game
                         quit = true; // End the game loop
                     }
@@ -311,6 +292,19 @@ void GUI::run() {
         }
 
     }
+
+    // The board only reports the result to the debug log, so tell the player how the game ended
+    if (!quit) {
+        if (board.isCheckmate(realPlayerColor)) {
+            std::cout << "Checkmate! " << (aiPlayerColor == PieceColor::WHITE ? "White" : "Black") << " wins!" << std::endl;
+        }
+        else if (board.isCheckmate(aiPlayerColor)) {
+            std::cout << "Checkmate! " << (realPlayerColor == PieceColor::WHITE ? "White" : "Black") << " wins!" << std::endl;
+        }
+        else {
+            std::cout << "It's a stalemate!" << std::endl;
+        }
+    }
     SDL_Quit();
 }
 
@@ -502,11 +496,15 @@ PieceColor GUI::choosePlayerColor() {
 }
 
 void GUI::printValidMoves(int selectedPieceRow, int selectedPieceCol) {
-    std::vector<Move> validMoves = generateMovesForPiece(board, selectedPieceRow, selectedPieceCol);
+    if (!LOG_ENABLED(LogLevel::DEBUG, LogCategory::GUI)) {
+        return;
+    }
+
+    MoveList validMoves;
+    generateMovesForPiece(board, selectedPieceRow, selectedPieceCol, validMoves);
 
-    std::cout << "Valid moves for the selected piece: " << std::endl;
     for (const Move& move : validMoves) {
-        std::cout << "Frome (" << selectedPieceRow << "," << selectedPieceCol << ") to (" << move.destRow << "," << move.destCol << ")" << std::endl;
+        LOG_DEBUG(GUI, "Valid move for the selected piece: (%d,%d) to (%d,%d)", selectedPieceRow, selectedPieceCol, move.destRow, move.destCol);
     }
 }
 
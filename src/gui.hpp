@@ -46,6 +46,13 @@ private:
 
     Board board;
 
+    // Lives as long as the game, so the transposition table carries over from one AI move to the next.
+    // Searches with one thread per core
+    Search search;
+
+    // Thinking time per AI move, the search deepens until it runs out
+    const int AI_MOVE_TIME_MS = 1000;
+
     SDL_Window* window;
     SDL_Renderer* renderer;
     Piece* selectedPiece;
@@ -0,0 +1,170 @@
+#include "log.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+static const char* const LEVEL_NAMES[] = { "TRACE", "DEBUG", "INFO", "WARN", "ERROR" };
+static const char* const CATEGORY_NAMES[] = { "general", "board", "movegen", "search", "gui" };
+
+// Debug builds show the GUI and board debug output by default, as the console prints they replace did
+#ifdef NDEBUG
+static std::atomic<uint8_t> minimumLevel((uint8_t)LogLevel::INFO);
+#else
+static std::atomic<uint8_t> minimumLevel((uint8_t)LogLevel::DEBUG);
+#endif
+static std::atomic<uint32_t> enabledCategories(~(uint32_t)0);
+
+namespace {
+
+struct LogRecord {
+    LogLevel level;
+    LogCategory category;
+    double seconds;
+    char text[240];
+};
+
+// Fixed ring of records shared by every logging thread and drained by one writer thread
+class LogQueue {
+public:
+    static const size_t SIZE = 4096;
+
+    LogQueue() : head(0), tail(0), dropped(0), stopping(false), writing(false), start(std::chrono::steady_clock::now()) {
+        writer = std::thread([this]() { run(); });
+    }
+
+    ~LogQueue() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        pending.notify_one();
+        writer.join();
+    }
+
+    double elapsed() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void push(const LogRecord& record) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (head - tail == SIZE) {
+                ++dropped;
+                return;
+            }
+            ring[head % SIZE] = record;
+            ++head;
+        }
+        pending.notify_one();
+    }
+
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        drained.wait(lock, [this]() { return tail == head && !writing; });
+    }
+
+private:
+    LogRecord ring[SIZE];
+    size_t head; // Next slot to write
+    size_t tail; // Next slot to print
+    uint64_t dropped;
+    bool stopping;
+    bool writing;
+    std::chrono::steady_clock::time_point start;
+
+    std::mutex mutex;
+    std::condition_variable pending;
+    std::condition_variable drained;
+    std::thread writer;
+
+    void run() {
+        LogRecord batch[64];
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            pending.wait(lock, [this]() { return stopping || tail != head; });
+            if (tail == head && stopping) {
+                break;
+            }
+
+            // Copy a batch out and print it without holding the lock
+            size_t count = 0;
+            while (tail != head && count < 64) {
+                batch[count++] = ring[tail % SIZE];
+                ++tail;
+            }
+            uint64_t droppedNow = dropped;
+            dropped = 0;
+            writing = true;
+            lock.unlock();
+
+            if (droppedNow > 0) {
+                std::fprintf(stdout, "[log] %llu messages dropped, buffer full\n", (unsigned long long)droppedNow);
+            }
+            for (size_t i = 0; i < count; ++i) {
+                const LogRecord& record = batch[i];
+                std::fprintf(stdout, "[%10.3f][%s][%s] %s\n", record.seconds, LEVEL_NAMES[(int)record.level],
+                    CATEGORY_NAMES[(int)record.category], record.text);
+            }
+            std::fflush(stdout);
+
+            lock.lock();
+            writing = false;
+            if (tail == head) {
+                drained.notify_all();
+            }
+        }
+    }
+};
+
+// Created on first use, so programs that never log never start the writer thread
+LogQueue& queue() {
+    static LogQueue instance;
+    return instance;
+}
+
+}
+
+void Logger::setLevel(LogLevel level) {
+    minimumLevel.store((uint8_t)level, std::memory_order_relaxed);
+}
+
+void Logger::setCategoryEnabled(LogCategory category, bool enabled) {
+    uint32_t bit = (uint32_t)1 << (int)category;
+    if (enabled) {
+        enabledCategories.fetch_or(bit, std::memory_order_relaxed);
+    }
+    else {
+        enabledCategories.fetch_and(~bit, std::memory_order_relaxed);
+    }
+}
+
+bool Logger::isEnabled(LogLevel level, LogCategory category) {
+    return (uint8_t)level >= minimumLevel.load(std::memory_order_relaxed) && level != LogLevel::OFF &&
+        (enabledCategories.load(std::memory_order_relaxed) >> (int)category) & 1;
+}
+
+void Logger::write(LogLevel level, LogCategory category, const char* format, ...) {
+    if (!isEnabled(level, category)) {
+        return;
+    }
+
+    LogRecord record;
+    record.level = level;
+    record.category = category;
+    record.seconds = queue().elapsed();
+
+    va_list args;
+    va_start(args, format);
+    std::vsnprintf(record.text, sizeof(record.text), format, args);
+    va_end(args);
+
+    queue().push(record);
+}
+
+void Logger::flush() {
+    queue().flush();
+}
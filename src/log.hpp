@@ -0,0 +1,79 @@
+#ifndef LOG_HPP
+#define LOG_HPP
+
+#include <cstdint>
+
+// Logging with levels and categories. Messages are formatted on the calling thread, pushed into a
+// ring buffer and written out by a background thread, so logging never waits on console I/O.
+// Logging is compiled out (arguments are never evaluated) unless CHESS_LOGGING is 1, which is
+// the default for builds without NDEBUG.
+#ifndef CHESS_LOGGING
+#ifdef NDEBUG
+#define CHESS_LOGGING 0
+#else
+#define CHESS_LOGGING 1
+#endif
+#endif
+
+enum class LogLevel : uint8_t {
+	TRACE,
+	DEBUG,
+	INFO,
+	WARN,
+	ERR,
+	OFF
+};
+
+enum class LogCategory : uint8_t {
+	GENERAL,
+	BOARD,
+	MOVEGEN,
+	SEARCH,
+	GUI,
+	COUNT
+};
+
+class Logger {
+public:
+	// Messages below this level are dropped before they are formatted (DEBUG by default, INFO with NDEBUG)
+	static void setLevel(LogLevel level);
+	static void setCategoryEnabled(LogCategory category, bool enabled);
+	static bool isEnabled(LogLevel level, LogCategory category);
+
+	// printf-style. Long messages are truncated, and messages are dropped (and counted) while the buffer is full
+	static void write(LogLevel level, LogCategory category, const char* format, ...)
+#if defined(__GNUC__)
+		__attribute__((format(printf, 3, 4)))
+#endif
+		;
+
+	// Blocks until everything logged so far has been written
+	static void flush();
+};
+
+#if CHESS_LOGGING
+#define LOG_AT(level, category, ...) \
+	do { \
+		if (Logger::isEnabled(level, category)) { \
+			Logger::write(level, category, __VA_ARGS__); \
+		} \
+	} while (0)
+#define LOG_ENABLED(level, category) Logger::isEnabled(level, category)
+#else
+// Still type-checks the arguments, but the call is dead code and nothing is evaluated
+#define LOG_AT(level, category, ...) \
+	do { \
+		if (false) { \
+			Logger::write(level, category, __VA_ARGS__); \
+		} \
+	} while (0)
+#define LOG_ENABLED(level, category) false
+#endif
+
+#define LOG_TRACE(category, ...) LOG_AT(LogLevel::TRACE, LogCategory::category, __VA_ARGS__)
+#define LOG_DEBUG(category, ...) LOG_AT(LogLevel::DEBUG, LogCategory::category, __VA_ARGS__)
+#define LOG_INFO(category, ...) LOG_AT(LogLevel::INFO, LogCategory::category, __VA_ARGS__)
+#define LOG_WARN(category, ...) LOG_AT(LogLevel::WARN, LogCategory::category, __VA_ARGS__)
+#define LOG_ERROR(category, ...) LOG_AT(LogLevel::ERR, LogCategory::category, __VA_ARGS__)
+
+#endif // LOG_HPP
@@ -2,13 +2,16 @@
 #define MOVE_HPP
 
 #include <cstdint>
+#include <functional>
+#include "types.hpp"
 
 // Enum to represent additional flags for special moves
 enum class MoveType {
     QUIET,     // Quiet move (non-capturing)
     CAPTURE,   // Capture move
-    CASTLING
-    // Add other move types as needed, e.g., EN_PASSANT, PROMOTION, CASTLING, etc.
+    CASTLING,
+    EN_PASSANT
+    // Add other move types as needed, e.g., PROMOTION, etc.
 };
 
 // Define a struct to represent a chess move
@@ -27,6 +30,157 @@ struct Move {
         Move(int srcRow, int srcCol, int destRow, int destCol, MoveType flags = MoveType::QUIET, PieceType promotionPiece = PieceType::EMPTY)
         : srcRow(srcRow), srcCol(srcCol), destRow(destRow), destCol(destCol), flags(flags), promotionPiece(promotionPiece) {}
 
+    // Two moves are the same if they go between the same squares with the same promotion
+    bool operator==(const Move& other) const {
+        return srcRow == other.srcRow && srcCol == other.srcCol && destRow == other.destRow && destCol == other.destCol &&
+            promotionPiece == other.promotionPiece;
+    }
+    bool operator!=(const Move& other) const { return !(*this == other); }
 };
 
+// Fixed-capacity list of moves that lives on the stack, so move generation never allocates.
+// 256 is more than the number of legal moves in any chess position
+class MoveList {
+public:
+    static const int MAX_MOVES = 256;
+
+    MoveList() : count(0) {}
+
+    void push_back(const Move& move) { slots[count++].move = move; }
+    void clear() { count = 0; }
+
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    Move& operator[](int index) { return slots[index].move; }
+    const Move& operator[](int index) const { return slots[index].move; }
+
+    Move* begin() { return &slots[0].move; }
+    Move* end() { return &slots[0].move + count; }
+    const Move* begin() const { return &slots[0].move; }
+    const Move* end() const { return &slots[0].move + count; }
+
+private:
+    // Storage that skips Move's default constructor, so an empty list costs nothing to create
+    union Slot {
+        Move move;
+        Slot() {}
+    };
+
+    Slot slots[MAX_MOVES];
+    int count;
+};
+
+// Compact 16-bit move, used where moves are stored rather than generated: the transposition table
+// keeps one per entry. Move lists, killers, countermoves and history still work on Move.
+// Bits 0-5 hold the source square, bits 6-11 the destination square (row * 8 + col, like the
+// Board bitboards, so square 0 is a8) and bits 12-15 a flag nibble: bit 2 marks captures, bit 3
+// marks promotions, whose low two bits give the promotion piece.
+class PackedMove {
+public:
+    static const uint16_t QUIET = 0;
+    static const uint16_t CASTLING = 2;
+    static const uint16_t CAPTURE = 4;
+    static const uint16_t EN_PASSANT = 5;
+    static const uint16_t PROMOTION = 8;          // + 0 knight, 1 bishop, 2 rook, 3 queen
+    static const uint16_t PROMOTION_CAPTURE = 12; // Same promotion piece encoding
+
+    // The null move (a8 to a8 can never be a real move)
+    PackedMove() : data(0) {}
+
+    PackedMove(int srcSquare, int destSquare, uint16_t flag)
+        : data((uint16_t)(srcSquare | (destSquare << 6) | (flag << 12))) {}
+
+    // Pack a row/col move, keeping its move type and promotion piece
+    explicit PackedMove(const Move& move) : data(0) {
+        uint16_t flag = QUIET;
+        switch (move.flags) {
+        case MoveType::CAPTURE: flag = CAPTURE; break;
+        case MoveType::CASTLING: flag = CASTLING; break;
+        case MoveType::EN_PASSANT: flag = EN_PASSANT; break;
+        default: break;
+        }
+
+        if (move.promotionPiece != PieceType::EMPTY) {
+            flag = (flag == CAPTURE ? PROMOTION_CAPTURE : PROMOTION) | promotionCode(move.promotionPiece);
+        }
+
+        *this = PackedMove(toSquare(move.srcRow, move.srcCol), toSquare(move.destRow, move.destCol), flag);
+    }
+
+    static PackedMove fromRaw(uint16_t raw) {
+        PackedMove move;
+        move.data = raw;
+        return move;
+    }
+
+    uint16_t raw() const { return data; }
+    bool isNull() const { return data == 0; }
+
+    int srcSquare() const { return data & 0x3F; }
+    int destSquare() const { return (data >> 6) & 0x3F; }
+    uint16_t flag() const { return data >> 12; }
+
+    int srcRow() const { return srcSquare() / 8; }
+    int srcCol() const { return srcSquare() % 8; }
+    int destRow() const { return destSquare() / 8; }
+    int destCol() const { return destSquare() % 8; }
+
+    bool isCapture() const { return (flag() & CAPTURE) != 0; }
+    bool isPromotion() const { return (flag() & PROMOTION) != 0; }
+    bool isCastling() const { return flag() == CASTLING; }
+    bool isEnPassant() const { return flag() == EN_PASSANT; }
+
+    PieceType promotionPiece() const {
+        if (!isPromotion()) {
+            return PieceType::EMPTY;
+        }
+        static const PieceType pieces[4] = { PieceType::KNIGHT, PieceType::BISHOP, PieceType::ROOK, PieceType::QUEEN };
+        return pieces[flag() & 3];
+    }
+
+    // Unpack into the row/col representation used by the rest of the engine
+    Move toMove() const {
+        MoveType type = MoveType::QUIET;
+        if (isCastling()) {
+            type = MoveType::CASTLING;
+        }
+        else if (isEnPassant()) {
+            type = MoveType::EN_PASSANT;
+        }
+        else if (isCapture()) {
+            type = MoveType::CAPTURE;
+        }
+        return Move(srcRow(), srcCol(), destRow(), destCol(), type, promotionPiece());
+    }
+
+    bool operator==(const PackedMove& other) const { return data == other.data; }
+    bool operator!=(const PackedMove& other) const { return data != other.data; }
+
+    static int toSquare(int row, int col) { return row * 8 + col; }
+
+private:
+    uint16_t data;
+
+    static uint16_t promotionCode(PieceType piece) {
+        switch (piece) {
+        case PieceType::KNIGHT: return 0;
+        case PieceType::BISHOP: return 1;
+        case PieceType::ROOK: return 2;
+        default: return 3;
+        }
+    }
+};
+
+static_assert(sizeof(PackedMove) == 2, "PackedMove must stay 16 bits");
+
+namespace std {
+    template <>
+    struct hash<PackedMove> {
+        size_t operator()(const PackedMove& move) const {
+            return std::hash<uint16_t>()(move.raw());
+        }
+    };
+}
+
 #endif // MOVE_HPP
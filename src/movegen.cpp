@@ -1,18 +1,29 @@
 // movegen.cpp
 
 #include "movegen.hpp"
-#include "piece.hpp"
 #include "move.hpp"
 #include "board.hpp"
+#include "attacks.hpp"
 #include <iostream>
 #include <cstdlib>
 #include <unordered_map>
 #include <utility>
 
-// Function to generate moves for a pawn
-std::vector<Move> generatePawnMoves(const Board& board, int srcRow, int srcCol) {
-    std::vector<Move> moves;
+// Add a pawn move, expanding it into the four promotions when the pawn reaches the last row
+static void addPawnMove(int srcRow, int srcCol, int destRow, int destCol, MoveType type, MoveList& moves) {
+    if (destRow == 0 || destRow == 7) {
+        moves.push_back({ srcRow, srcCol, destRow, destCol, type, PieceType::QUEEN });
+        moves.push_back({ srcRow, srcCol, destRow, destCol, type, PieceType::ROOK });
+        moves.push_back({ srcRow, srcCol, destRow, destCol, type, PieceType::BISHOP });
+        moves.push_back({ srcRow, srcCol, destRow, destCol, type, PieceType::KNIGHT });
+    }
+    else {
+        moves.push_back({ srcRow, srcCol, destRow, destCol, type });
+    }
+}
 
+// Function to generate moves for a pawn
+void generatePawnMoves(const Board& board, int srcRow, int srcCol, MoveList& moves) {
     PieceColor pieceColor = board.getPieceColor(srcRow, srcCol);
 
     int forwardDirection = (pieceColor == PieceColor::WHITE) ? -1 : 1;
@@ -21,7 +32,7 @@ std::vector<Move> generatePawnMoves(const Board& board, int srcRow, int srcCol)
     int destRow = srcRow + forwardDirection;
     int destCol = srcCol;
     if (board.isEmpty(destRow, destCol)) {
-        moves.push_back({ srcRow, srcCol, destRow, destCol, MoveType::QUIET });
+        addPawnMove(srcRow, srcCol, destRow, destCol, MoveType::QUIET, moves);
     }
 
     //Check the double square advance (only if the pawn is in it's starting position)
@@ -40,7 +51,12 @@ std::vector<Move> generatePawnMoves(const Board& board, int srcRow, int srcCol)
             PieceType targetPieceType = board.getPieceType(targetRow, targetCol);
             PieceColor targetPieceColor = board.getPieceColor(targetRow, targetCol);
             if (targetPieceType != PieceType::EMPTY && targetPieceColor != pieceColor) {
-                moves.push_back({ srcRow, srcCol, targetRow, targetCol, MoveType::CAPTURE });
+                addPawnMove(srcRow, srcCol, targetRow, targetCol, MoveType::CAPTURE, moves);
+            }
+            // En passant: the target square is the one the enemy pawn skipped over on its double push
+            else if (targetRow * 8 + targetCol == board.getEnPassantSquare() &&
+                targetRow == (pieceColor == PieceColor::WHITE ? 2 : 5)) {
+                moves.push_back({ srcRow, srcCol, targetRow, targetCol, MoveType::EN_PASSANT });
             }
         }
     };
@@ -50,57 +66,31 @@ std::vector<Move> generatePawnMoves(const Board& board, int srcRow, int srcCol)
 
     // Capture to the right
     tryCaptureMove(srcRow + forwardDirection, srcCol + 1);
+}
 
-    // TODO: Implement en passant logic
+// Turn a destination mask into moves, tagging the ones that land on an enemy piece as captures
+static void addMovesFromMask(const Board& board, int srcRow, int srcCol, uint64_t targets, MoveList& moves) {
+    uint64_t enemies = board.getOccupancy(getOppositeColor(board.getPieceColor(srcRow, srcCol)));
 
-    return moves;
+    while (targets) {
+        int destSquare = popLSB(targets);
+        MoveType type = (enemies & squareBit(destSquare)) ? MoveType::CAPTURE : MoveType::QUIET;
+        moves.push_back({ srcRow, srcCol, destSquare / 8, destSquare % 8, type });
+    }
 }
 
 // Function to generate moves for a rook
-std::vector<Move> generateRookMoves(const Board& board, int srcRow, int srcCol) {
-    std::vector<Move> moves;
-
-    //Define the four cardinal directions: up, down, left, right
-    int dr[] = { -1, 1, 0, 0 };
-    int dc[] = { 0, 0, -1, 1 };
+void generateRookMoves(const Board& board, int srcRow, int srcCol, MoveList& moves) {
 
     PieceColor pieceColor = board.getPieceColor(srcRow, srcCol);
 
-    //Check moves in each of the four directions
-    for (int i = 0; i < 4; ++i) {
-        int destRow = srcRow + dr[i];
-        int destCol = srcCol + dc[i];
-
-        //Keep extending the move in the current direction until we reach the edge of the board or another piece
-        while (board.isValidPosition(destRow, destCol)) {
-            PieceColor targetPieceColor = board.getPieceColor(destRow, destCol);
-
-            //If the destination square is empty, it's a quiet move
-            if (targetPieceColor == PieceColor::EMPTY) {
-                moves.push_back({ srcRow, srcCol, destRow, destCol, MoveType::QUIET });
-            }
-            //If the destination square has an opponent's piece, it's a capture move
-            else if (targetPieceColor != pieceColor) {
-                moves.push_back({ srcRow, srcCol, destRow, destCol, MoveType::CAPTURE });
-                break;// Can't go beyond a capture piece
-            }
-            else {
-                //If the destination square has a piece of the same color, we cannot move beyond it
-                break;
-            }
-
-            //Move further along the current direction
-            destRow += dr[i];
-            destCol += dc[i];
-        }
-    }
-
-    return moves;
+    //Look up the horizontal and vertical rays from the magic tables, they stop at the first blocker in each direction
+    uint64_t targets = rookAttacks(srcRow * 8 + srcCol, board.getOccupancy()) & ~board.getOccupancy(pieceColor);
+    addMovesFromMask(board, srcRow, srcCol, targets, moves);
 }
 
 // Function to generate moves for a knight
-std::vector<Move> generateKnightMoves(const Board& board, int srcRow, int srcCol) {
-    std::vector<Move> moves;
+void generateKnightMoves(const Board& board, int srcRow, int srcCol, MoveList& moves) {
 
     PieceColor pieceColor = board.getPieceColor(srcRow, srcCol);
 
@@ -118,72 +108,30 @@ std::vector<Move> generateKnightMoves(const Board& board, int srcRow, int srcCol
             }
         }
     }
-
-    return moves;
 }
 
 // Function to generate moves for a bishop
-std::vector<Move> generateBishopMoves(const Board& board, int srcRow, int srcCol) {
-    std::vector<Move> moves;
-
-    //Define the diagonal directions: top-left, top-right, bottom-left, bottom-right
-    int dr[] = { -1, -1, 1, 1 };
-    int dc[] = { -1, 1, -1, 1 };
+void generateBishopMoves(const Board& board, int srcRow, int srcCol, MoveList& moves) {
 
     PieceColor pieceColor = board.getPieceColor(srcRow, srcCol);
 
-    //Check moves in each diagonal direction
-    for (int i = 0; i < 4; ++i) {
-        int destRow = srcRow + dr[i];
-        int destCol = srcCol + dc[i];
-
-        //Keep extending the move in the current diagonal direction until we reach the edge of the board or another piece
-        while (board.isValidPosition(destRow, destCol)) {
-            PieceColor targetPieceColor = board.getPieceColor(destRow, destCol);
-
-            //If the destination square is empty, it's a quiet move
-            if (targetPieceColor == PieceColor::EMPTY) {
-                moves.push_back({ srcRow, srcCol, destRow, destCol, MoveType::QUIET });
-            }
-            //If the destination square has an opponent's piece, it's a capture move
-            else if (targetPieceColor != pieceColor) {
-                moves.push_back({ srcRow, srcCol, destRow, destCol, MoveType::CAPTURE });
-                break; //Can't go beyond a captured piece
-            }
-            else {
-                //If the destination square has a piece of the same color, we can't move beyond it
-                break;
-            }
-
-            //Move further along the diagonal
-            destRow += dr[i];
-            destCol += dc[i];
-        }
-    }
-
-    return moves;
+    //Look up the diagonal rays from the magic tables
+    uint64_t targets = bishopAttacks(srcRow * 8 + srcCol, board.getOccupancy()) & ~board.getOccupancy(pieceColor);
+    addMovesFromMask(board, srcRow, srcCol, targets, moves);
 }
 
 // Function to generate moves for a queen
-std::vector<Move> generateQueenMoves(const Board& board, int srcRow, int srcCol) {
-    std::vector<Move> moves;
-
-    //Reuse the logic from the rook and bishop functions
+void generateQueenMoves(const Board& board, int srcRow, int srcCol, MoveList& moves) {
 
-    //Generate rook-like moves (horizontal and vertical)
-    std::vector<Move> rookMoves = generateRookMoves(board, srcRow, srcCol);
-    moves.insert(moves.end(), rookMoves.begin(), rookMoves.end());
-
-    //Generate bishop-like moves (diagonal)
-    std::vector<Move> bishopMoves = generateBishopMoves(board, srcRow, srcCol);
-    moves.insert(moves.end(), bishopMoves.begin(), bishopMoves.end());
+    PieceColor pieceColor = board.getPieceColor(srcRow, srcCol);
 
-    return moves;
+    //A queen attacks the union of the rook and bishop rays
+    uint64_t targets = queenAttacks(srcRow * 8 + srcCol, board.getOccupancy()) & ~board.getOccupancy(pieceColor);
+    addMovesFromMask(board, srcRow, srcCol, targets, moves);
 }
 
 // Function to generate moves for a king
-std::vector<Move> generateKingMoves(const Board& board, int srcRow, int srcCol) {
-    std::vector<Move> moves;
+void generateKingMoves(const Board& board, int srcRow, int srcCol, MoveList& moves) {
 
     PieceColor pieceColor = board.getPieceColor(srcRow, srcCol);
 
@@ -208,114 +156,22 @@ std::vector<Move> generateKingMoves(const Board& board, int srcRow, int srcCol)
     }
 
     // Generate castling moves
-    std::vector<Move> castlingMoves = generateCastlingMoves(board, srcRow, srcCol);
-
-    //moves.insert(moves.end(), castlingMovesAlive.begin(), castlingMovesAlive.end());
-    moves.insert(moves.end(), castlingMoves.begin(), castlingMoves.end());
-
-    return moves;
+    generateCastlingMoves(board, srcRow, srcCol, moves);
 }
 
 PieceColor getOppositeColor(PieceColor color) {
     return (color == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
 }
 
-// Function to check if a square is under attack by an opponent's piece
+// Function to check if a square is under attack by an opponent's piece.
+// A lookup in the attack map the board keeps for the attacking side
 bool isSquareAttacked(const Board& board, int row, int col, PieceColor attackingColor) {
-    int dr[] = { -1, -1, -1, 0, 0, 1, 1, 1 };
-    int dc[] = { -1, 0, 1, -1, 1, -1, 0, 1 };
-
-    // Check for non-sliding attacks (knights, kings, and pawns)
-    for (int i = 0; i < 8; ++i) {
-        int targetRow = row + dr[i];
-        int targetCol = col + dc[i];
-        if (board.isValidPosition(targetRow, targetCol)) {
-            PieceColor targetPieceColor = board.getPieceColor(targetRow, targetCol);
-            PieceType targetPieceType = board.getPieceType(targetRow, targetCol);
-            if (targetPieceColor == attackingColor) {
-                if (targetPieceType == PieceType::KNIGHT) {
-                    if ((std::abs(dr[i]) == 2 && std::abs(dc[i]) == 1) || (std::abs(dr[i]) == 1 && std::abs(dc[i]) == 2)) {
-                        return true;
-                    }
-                }
-                else if (targetPieceType == PieceType::KING) {
-                    if (std::abs(dr[i]) <= 1 && std::abs(dc[i]) <= 1) {
-                        return true;
-                    }
-                }
-                else if (targetPieceType == PieceType::PAWN) {
-                    if (attackingColor == PieceColor::WHITE) {
-                        if (i == 4 && dr[i] == -1 && dc[i] == -1) { // White pawn capturing to the top-left
-                            return true;
-                        }
-                        else if (i == 5 && dr[i] == -1 && dc[i] == 1) { // White pawn capturing to the top-right
-                            return true;
-                        }
-                    }
-                    else {
-                        if (i == 6 && dr[i] == 1 && dc[i] == -1) { // Black pawn capturing to the bottom-left
-                            return true;
-                        }
-                        else if (i == 7 && dr[i] == 1 && dc[i] == 1) { // Black pawn capturing to the bottom-right
-                            return true;
-                        }
-                    }
-                }
-            }
-        }
-    }
-
-    // Check for sliding attacks (rooks, bishops, and queens)
-    int slidingDirections[] = { -1, 1, 0 }; // -1 represents negative direction, 1 represents positive direction, 0 represents no movement
-    for (int drDir : slidingDirections) {
-        for (int dcDir : slidingDirections) {
-            if (drDir == 0 && dcDir == 0) continue; // Skip the case where both directions are 0 (no movement)
-            for (int step = 1; step < 8; ++step) {
-                int targetRow = row + drDir * step;
-                int targetCol = col + dcDir * step;
-                if (!board.isValidPosition(targetRow, targetCol)) break; // Stop if the target square is not valid
-                PieceColor targetPieceColor = board.getPieceColor(targetRow, targetCol);
-                if (targetPieceColor == attackingColor) {
-                    PieceType targetPieceType = board.getPieceType(targetRow, targetCol);
-                    if (targetPieceType == PieceType::ROOK || targetPieceType == PieceType::QUEEN) {
-                        return true;
-                    }
-                    else {
-                        // We reached a piece that is of the same color, no need to check further in this direction
-                        break;
-                    }
-                }
-                else if (targetPieceColor != PieceColor::EMPTY) {
-                    // We reached a piece of the opponent's color that is not a rook or queen, no need to check further in this direction
-                    break;
-                }
-            }
-        }
-    }
-
-    return false;
+    return (board.getAttacks(attackingColor) >> (row * 8 + col)) & 1;
 }
 
 //Check if a player is in check
 bool isCheck(const Board& board, PieceColor color) {
-    int kingRow = -1;
-    int kingCol = -1;
-    for (int row = 0; row < 8; ++row) {
-        for (int col = 0; col < 8; ++col) {
-            if (board.getPieceType(row, col) == PieceType::KING && board.getPieceColor(row, col) == color) {
-                kingRow = row;
-                kingCol = col;
-                break;
-            }
-        }
-    }
-
-    if (kingRow == -1 || kingCol == -1) {
-        //King not found, something's wrong with the board
-        return false;
-    }
-    //Check if the square where the king is located is under attack by the opponent
-    return isSquareAttacked(board, kingRow, kingCol, getOppositeColor(color));
+    return board.isInCheck(color);
 }
 
 //Check if a player is in checkmate
@@ -325,91 +181,65 @@ bool isCheckmate(const Board& board, PieceColor color) {
     }
 
     //Check if the player has any legal moves to get out of check
-    for (int row = 0; row < 8; ++row) {
-        for (int col = 0; col < 8; ++col) {
-            if (board.getPieceColor(row, col) == color) {
-                std::vector<Move> moves = generateMovesForPiece(board, row, col);
-                for (const Move& move : moves) {
-                    int srcRow = move.srcRow;
-                    int srcCol = move.srcCol;
-                    int destRow = move.destRow;
-                    int destCol = move.destCol;
-
-                    Board newBoard = board;
-                    newBoard.makeMove(srcRow, srcCol, destRow, destCol);
-                    if (!isCheck(newBoard, color)) {
-                        //Found a legal move to get out of check
-                        return false;
-                    }
-                }
-            }
-        }
-    }
-    return true;
+    return !hasAnyLegalMove(board, color);
 }
 
-// Function to generate moves for a piece and apply them to a copy of the board
-std::vector<Move> generateMovesForPiece(const Board& board, int row, int col)
+// Function to append the moves of the piece on the given square to the list
+void generateMovesForPiece(const Board& board, int row, int col, MoveList& moves)
 {
     PieceType pieceType = board.getPieceType(row, col);
-    PieceColor pieceColor = board.getPieceColor(row, col);
 
     if (pieceType == PieceType::PAWN) {
-        return generatePawnMoves(board, row, col);
+        generatePawnMoves(board, row, col, moves);
     }
     else if (pieceType == PieceType::ROOK) {
-        return generateRookMoves(board, row, col);
+        generateRookMoves(board, row, col, moves);
     }
     else if (pieceType == PieceType::KNIGHT) {
-        return generateKnightMoves(board, row, col);
+        generateKnightMoves(board, row, col, moves);
     }
     else if (pieceType == PieceType::BISHOP) {
-        return generateBishopMoves(board, row, col);
+        generateBishopMoves(board, row, col, moves);
     }
     else if (pieceType == PieceType::QUEEN) {
-        return generateQueenMoves(board, row, col);
+        generateQueenMoves(board, row, col, moves);
     }
     else if (pieceType == PieceType::KING) {
-        return generateKingMoves(board, row, col);
+        generateKingMoves(board, row, col, moves);
     }
-
-    // Return an empty vector if the piece type is unknown
-    return {};
 }
 
-std::vector<Move> generateAllMoves(const Board& board, PieceColor color) {
-    std::vector<Move> allMoves;
-
-    for (int row = 0; row < board.BOARD_SIZE; ++row) {
-        for (int col = 0; col < board.BOARD_SIZE; ++col) {
-            PieceColor pieceColor = board.getPieceColor(row, col);
-            if (pieceColor == color) {
-                std::vector<Move> moves = generateMovesForPiece(board, row, col);
-                allMoves.insert(allMoves.end(), moves.begin(), moves.end());
-            }
-        }
+void generateAllMoves(const Board& board, PieceColor color, MoveList& moves) {
+    //Walk the pieces of this color straight from the occupancy bitboard
+    uint64_t pieces = board.getOccupancy(color);
+    while (pieces) {
+        int square = popLSB(pieces);
+        generateMovesForPiece(board, square / 8, square % 8, moves);
     }
-
-    return allMoves;
 }
 
 
-std::vector<Move> generateCastlingMoves(const Board& board, int srcRow, int srcCol) {
-    std::vector<Move> moves;
+void generateCastlingMoves(const Board& board, int srcRow, int srcCol, MoveList& moves) {
 
     PieceColor pieceColor = board.getPieceColor(srcRow, srcCol);
     int kingRow = srcRow;
     int kingCol = srcCol;
 
-    //if (board.hasPieceMoved(kingRow, kingCol)) {
-        //std::cout << "No castling moves: King has moved";
-        //return moves;
-    //}
+    // Castling is only possible from the king's starting square
+    int homeRow = (pieceColor == PieceColor::WHITE) ? board.BOARD_SIZE - 1 : 0;
+    if (kingRow != homeRow || kingCol != 4) {
+        return;
+    }
+
+    auto isOwnRook = [&](int col) {
+        return board.getPieceType(kingRow, col) == PieceType::ROOK && board.getPieceColor(kingRow, col) == pieceColor;
+    };
 
     // Check for king-side castling
     int kingSideRookCol = board.BOARD_SIZE - 1;
     if (!board.hasPieceMoved(kingRow, kingCol) &&
         !board.hasPieceMoved(kingRow, kingSideRookCol) &&
+        isOwnRook(kingSideRookCol) &&
         board.isEmpty(kingRow, kingCol + 1) &&
         board.isEmpty(kingRow, kingCol + 2) &&
         !isSquareAttacked(board, kingRow, kingCol, getOppositeColor(pieceColor)) &&
@@ -425,6 +255,7 @@ std::vector<Move> generateCastlingMoves(const Board& board, int srcRow, int srcC
     int queenSideRookCol = 0;
     if (!board.hasPieceMoved(kingRow, kingCol) &&
         !board.hasPieceMoved(kingRow, queenSideRookCol) &&
+        isOwnRook(queenSideRookCol) &&
         board.isEmpty(kingRow, kingCol - 1) &&
         board.isEmpty(kingRow, kingCol - 2) &&
         board.isEmpty(kingRow, kingCol - 3) &&
@@ -437,7 +268,264 @@ std::vector<Move> generateCastlingMoves(const Board& board, int srcRow, int srcC
         moves.push_back({ srcRow, srcCol, kingRow, kingCol - 4, MoveType::CASTLING });
     }
 
+}
+
 
-    return moves;
+// Captures, en passant and promotions; everything else (including castling) is quiet
+static bool isTactical(const Move& move) {
+    return move.flags == MoveType::CAPTURE || move.flags == MoveType::EN_PASSANT || move.promotionPiece != PieceType::EMPTY;
 }
 
+// Generates the legal moves of the given color and kind, for the pieces on the fromMask squares, into the list.
+// Without a list it stops at the first legal move. Returns whether there is at least one such move
+static bool generateLegal(const Board& board, PieceColor color, MoveList* moves, GenType genType, uint64_t fromMask) {
+    PieceColor enemyColor = getOppositeColor(color);
+    uint64_t occupancy = board.getOccupancy();
+    uint64_t own = board.getOccupancy(color);
+    uint64_t enemies = board.getOccupancy(enemyColor);
+    uint64_t king = board.getPieces(PieceType::KING, color);
+    bool found = false;
+
+    // Destination squares allowed for this kind of move (pawns are filtered per move)
+    uint64_t genTargets = ~(uint64_t)0;
+    if (genType == GenType::CAPTURES) {
+        genTargets = enemies;
+    }
+    else if (genType == GenType::QUIETS) {
+        genTargets = ~enemies;
+    }
+
+    auto add = [&](const Move& move) {
+        found = true;
+        if (moves) {
+            moves->push_back(move);
+        }
+    };
+
+    if (!king) {
+        // Without a king there is nothing to keep safe, every pseudo-legal move is legal
+        MoveList pseudoMoves;
+        generateAllMoves(board, color, pseudoMoves);
+        for (const Move& move : pseudoMoves) {
+            bool wanted = genType == GenType::ALL || isTactical(move) == (genType == GenType::CAPTURES);
+            if (wanted && (fromMask & squareBit(move.srcRow * 8 + move.srcCol))) {
+                add(move);
+            }
+        }
+        return found;
+    }
+
+    int kingSquare = bitScanForward(king);
+    uint64_t enemyAttacks = board.getAttacks(enemyColor);
+    uint64_t checkers = board.getCheckers();
+    if (color != board.getSideToMove()) {
+        checkers = (enemyAttacks & king) ? board.attackersTo(kingSquare, occupancy) & enemies : 0;
+    }
+
+    // King moves: squares in the enemy attack map are never safe. Out of check that is the whole test,
+    // in check the destination is also tested with the king lifted off the board, so a slider
+    // checking along a line also covers the square behind the king
+    uint64_t withoutKing = occupancy ^ king;
+    uint64_t kingTargets = (king & fromMask) ? kingAttacks(kingSquare) & ~own & ~enemyAttacks & genTargets : 0;
+    while (kingTargets) {
+        int destSquare = popLSB(kingTargets);
+        if (!checkers || !(board.attackersTo(destSquare, withoutKing) & enemies)) {
+            MoveType type = (enemies & squareBit(destSquare)) ? MoveType::CAPTURE : MoveType::QUIET;
+            add({ kingSquare / 8, kingSquare % 8, destSquare / 8, destSquare % 8, type });
+            if (!moves) {
+                return true;
+            }
+        }
+    }
+
+    // In double check only the king can move
+    if (popCount(checkers) > 1) {
+        return found;
+    }
+
+    // Destinations that resolve a single check: capturing the checker or blocking its line
+    uint64_t checkMask = ~(uint64_t)0;
+    if (checkers) {
+        checkMask = checkers | betweenSquares(kingSquare, bitScanForward(checkers));
+    }
+    else if (genType != GenType::CAPTURES && (king & fromMask)) {
+        MoveList castlingMoves;
+        generateCastlingMoves(board, kingSquare / 8, kingSquare % 8, castlingMoves);
+        for (const Move& move : castlingMoves) {
+            add(move);
+        }
+    }
+
+    // Pinned pieces: own pieces that are the only blocker between the king and an enemy slider
+    uint64_t pinned = 0;
+    uint64_t enemyQueens = board.getPieces(PieceType::QUEEN, enemyColor);
+    uint64_t snipers = (rookAttacks(kingSquare, 0) & (board.getPieces(PieceType::ROOK, enemyColor) | enemyQueens)) |
+        (bishopAttacks(kingSquare, 0) & (board.getPieces(PieceType::BISHOP, enemyColor) | enemyQueens));
+    while (snipers) {
+        uint64_t blockers = betweenSquares(kingSquare, popLSB(snipers)) & occupancy;
+        if (blockers && !(blockers & (blockers - 1)) && (blockers & own)) {
+            pinned |= blockers;
+        }
+    }
+
+    uint64_t pieces = own & ~king & fromMask;
+    while (pieces) {
+        if (found && !moves) {
+            return true;
+        }
+
+        int srcSquare = popLSB(pieces);
+        int srcRow = srcSquare / 8;
+        int srcCol = srcSquare % 8;
+
+        // A pinned piece may only move along the line through its king
+        uint64_t allowed = checkMask;
+        if (pinned & squareBit(srcSquare)) {
+            allowed &= lineThrough(kingSquare, srcSquare);
+        }
+
+        PieceType pieceType = board.getPieceType(srcRow, srcCol);
+        if (pieceType == PieceType::PAWN) {
+            MoveList pawnMoves;
+            generatePawnMoves(board, srcRow, srcCol, pawnMoves);
+            for (const Move& move : pawnMoves) {
+                int destSquare = move.destRow * 8 + move.destCol;
+                if (genType != GenType::ALL && isTactical(move) != (genType == GenType::CAPTURES)) {
+                    continue;
+                }
+                if (move.flags == MoveType::EN_PASSANT) {
+                    // Both pawns leave the row at once, so replay the capture on the occupancy and look
+                    // for any attacker left on the king (this also catches the horizontal pin)
+                    int capturedSquare = srcRow * 8 + move.destCol;
+                    uint64_t after = (occupancy ^ squareBit(srcSquare) ^ squareBit(capturedSquare)) | squareBit(destSquare);
+                    if (!(board.attackersTo(kingSquare, after) & enemies & ~squareBit(capturedSquare))) {
+                        add(move);
+                    }
+                }
+                else if (allowed & squareBit(destSquare)) {
+                    add(move);
+                }
+            }
+            continue;
+        }
+
+        uint64_t attacks = 0;
+        switch (pieceType) {
+        case PieceType::KNIGHT: attacks = knightAttacks(srcSquare); break;
+        case PieceType::BISHOP: attacks = bishopAttacks(srcSquare, occupancy); break;
+        case PieceType::ROOK: attacks = rookAttacks(srcSquare, occupancy); break;
+        case PieceType::QUEEN: attacks = queenAttacks(srcSquare, occupancy); break;
+        default: break;
+        }
+
+        uint64_t targets = attacks & ~own & allowed & genTargets;
+        while (targets) {
+            int destSquare = popLSB(targets);
+            MoveType type = (enemies & squareBit(destSquare)) ? MoveType::CAPTURE : MoveType::QUIET;
+            add({ srcRow, srcCol, destSquare / 8, destSquare % 8, type });
+        }
+    }
+
+    return found;
+}
+
+void generateLegalMoves(const Board& board, PieceColor color, MoveList& moves, GenType genType) {
+    generateLegal(board, color, &moves, genType, ~(uint64_t)0);
+}
+
+bool hasAnyLegalMove(const Board& board, PieceColor color) {
+    return generateLegal(board, color, nullptr, GenType::ALL, ~(uint64_t)0);
+}
+
+bool isLegalMove(const Board& board, const Move& move) {
+    if (!board.isValidPosition(move.srcRow, move.srcCol) || !board.isValidPosition(move.destRow, move.destCol)) {
+        return false;
+    }
+
+    PieceColor color = board.getPieceColor(move.srcRow, move.srcCol);
+    if (color == PieceColor::EMPTY) {
+        return false;
+    }
+
+    // Only the piece on the source square needs its moves generated
+    MoveList legalMoves;
+    generateLegal(board, color, &legalMoves, GenType::ALL, squareBit(move.srcRow * 8 + move.srcCol));
+    for (const Move& legalMove : legalMoves) {
+        if (legalMove.destRow == move.destRow && legalMove.destCol == move.destCol &&
+            (move.promotionPiece == PieceType::EMPTY || move.promotionPiece == legalMove.promotionPiece)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool isCheckingMove(const Board& board, const Move& move) {
+    int srcSquare = move.srcRow * 8 + move.srcCol;
+    int destSquare = move.destRow * 8 + move.destCol;
+    PieceType pieceType = board.getPieceType(move.srcRow, move.srcCol);
+    PieceColor color = board.getPieceColor(move.srcRow, move.srcCol);
+    PieceColor enemyColor = getOppositeColor(color);
+
+    uint64_t enemyKing = board.getPieces(PieceType::KING, enemyColor);
+    if (!enemyKing) {
+        return false;
+    }
+    int kingSquare = bitScanForward(enemyKing);
+    uint64_t occupancy = board.getOccupancy();
+
+    // Occupancy once the move is made, and the squares the move empties that might have screened the king
+    uint64_t after = (occupancy & ~squareBit(srcSquare)) | squareBit(destSquare);
+    uint64_t vacated = squareBit(srcSquare);
+    uint64_t movedSliders = squareBit(srcSquare);
+
+    // Castling moves the king onto its own rook, the rook then checks from next to the king's new square
+    if (pieceType == PieceType::KING && board.getPieceType(move.destRow, move.destCol) == PieceType::ROOK &&
+        board.getPieceColor(move.destRow, move.destCol) == color) {
+        bool kingSide = (move.destCol == 7);
+        int kingDest = move.destRow * 8 + (kingSide ? 6 : 2);
+        int rookDest = move.destRow * 8 + (kingSide ? 5 : 3);
+        after = (occupancy & ~squareBit(srcSquare) & ~squareBit(destSquare)) | squareBit(kingDest) | squareBit(rookDest);
+        if (rookAttacks(rookDest, after) & enemyKing) {
+            return true;
+        }
+        vacated |= squareBit(destSquare);
+        movedSliders |= squareBit(destSquare);
+    }
+    else {
+        // Direct check from the destination square, by the promoted piece if there is one
+        PieceType placedType = pieceType;
+        int lastRow = (color == PieceColor::WHITE) ? 0 : 7;
+        if (pieceType == PieceType::PAWN && move.destRow == lastRow && move.promotionPiece != PieceType::EMPTY) {
+            placedType = move.promotionPiece;
+        }
+
+        uint64_t attacks = 0;
+        switch (placedType) {
+        case PieceType::PAWN: attacks = pawnAttacks(color, destSquare); break;
+        case PieceType::KNIGHT: attacks = knightAttacks(destSquare); break;
+        case PieceType::BISHOP: attacks = bishopAttacks(destSquare, after); break;
+        case PieceType::ROOK: attacks = rookAttacks(destSquare, after); break;
+        case PieceType::QUEEN: attacks = queenAttacks(destSquare, after); break;
+        default: break;
+        }
+        if (attacks & enemyKing) {
+            return true;
+        }
+
+        // En passant also takes the captured pawn off its square
+        if (pieceType == PieceType::PAWN && destSquare == board.getEnPassantSquare() && move.srcCol != move.destCol) {
+            uint64_t capturedPawn = squareBit(move.srcRow * 8 + move.destCol);
+            after &= ~capturedPawn;
+            vacated |= capturedPawn;
+        }
+    }
+
+    // Discovered check: only possible if a vacated square was the first piece on a line from the king
+    if (!(queenAttacks(kingSquare, occupancy) & vacated)) {
+        return false;
+    }
+    uint64_t queens = board.getPieces(PieceType::QUEEN, color);
+    uint64_t rooks = (board.getPieces(PieceType::ROOK, color) | queens) & ~movedSliders;
+    uint64_t bishops = (board.getPieces(PieceType::BISHOP, color) | queens) & ~movedSliders;
+    return (rookAttacks(kingSquare, after) & rooks) || (bishopAttacks(kingSquare, after) & bishops);
+}
@@ -5,17 +5,35 @@
 
 
 // Forward declarations for the piece-specific move generation functions
-std::vector<Move> generatePawnMoves(const Board& board, int srcRow, int srcCol);
-std::vector<Move> generateRookMoves(const Board& board, int srcRow, int srcCol);
-std::vector<Move> generateKnightMoves(const Board& board, int srcRow, int srcCol);
-std::vector<Move> generateBishopMoves(const Board& board, int srcRow, int srcCol);
-std::vector<Move> generateQueenMoves(const Board& board, int srcRow, int srcCol);
-std::vector<Move> generateKingMoves(const Board& board, int srcRow, int srcCol);
-
-std::vector<Move> generateMovesForPiece(const Board& board, int row, int col);
-std::vector<Move> generateAllMoves(const Board& board, PieceColor color);
-
-std::vector<Move> generateCastlingMoves(const Board& board, int srcRow, int srcCol);
+// Every generator appends to the caller-provided list instead of returning a new one
+void generatePawnMoves(const Board& board, int srcRow, int srcCol, MoveList& moves);
+void generateRookMoves(const Board& board, int srcRow, int srcCol, MoveList& moves);
+void generateKnightMoves(const Board& board, int srcRow, int srcCol, MoveList& moves);
+void generateBishopMoves(const Board& board, int srcRow, int srcCol, MoveList& moves);
+void generateQueenMoves(const Board& board, int srcRow, int srcCol, MoveList& moves);
+void generateKingMoves(const Board& board, int srcRow, int srcCol, MoveList& moves);
+
+void generateMovesForPiece(const Board& board, int row, int col, MoveList& moves);
+void generateAllMoves(const Board& board, PieceColor color, MoveList& moves);
+
+void generateCastlingMoves(const Board& board, int srcRow, int srcCol, MoveList& moves);
+
+// Which moves a generator call should produce. CAPTURES also includes en passant and promotions,
+// QUIETS is everything else, so the two together are exactly ALL
+enum class GenType {
+    ALL,
+    CAPTURES,
+    QUIETS
+};
+
+// Legal move generation: checkers, pinned pieces and check evasion masks are computed once per
+// position, so only moves that don't leave the own king in check are emitted
+void generateLegalMoves(const Board& board, PieceColor color, MoveList& moves, GenType genType = GenType::ALL);
+bool hasAnyLegalMove(const Board& board, PieceColor color);
+// Whether the move is legal for the piece on its source square (a move without a promotion piece matches any promotion)
+bool isLegalMove(const Board& board, const Move& move);
+// Whether making the (legal) move puts the other king in check, directly or by discovery, without making it
+bool isCheckingMove(const Board& board, const Move& move);
 
 bool isSquareAttacked(const Board& board, int row, int col, PieceColor attackingColor);
 
@@ -0,0 +1,221 @@
+#include "movepick.hpp"
+#include "eval.hpp"
+#include "see.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+static bool isNone(const Move& move) {
+    return move.srcRow < 0;
+}
+
+// Whether the move is legal here for the side to move. A pawn reaching the last row must name its promotion piece,
+// since the move may have been stored for a different piece in another position
+static bool isPlayable(const Board& board, PieceColor color, const Move& move) {
+    if (board.getPieceColor(move.srcRow, move.srcCol) != color) {
+        return false;
+    }
+    if (board.getPieceType(move.srcRow, move.srcCol) == PieceType::PAWN && (move.destRow == 0 || move.destRow == 7) &&
+        move.promotionPiece == PieceType::EMPTY) {
+        return false;
+    }
+    return isLegalMove(board, move);
+}
+
+void ButterflyHistory::clear() {
+    for (int side = 0; side < 2; ++side) {
+        for (int from = 0; from < 64; ++from) {
+            for (int to = 0; to < 64; ++to) {
+                table[side][from][to] = 0;
+            }
+        }
+    }
+}
+
+void ButterflyHistory::age() {
+    for (int side = 0; side < 2; ++side) {
+        for (int from = 0; from < 64; ++from) {
+            for (int to = 0; to < 64; ++to) {
+                table[side][from][to] /= 2;
+            }
+        }
+    }
+}
+
+void ButterflyHistory::update(PieceColor color, const Move& move, int bonus) {
+    int& score = table[color == PieceColor::WHITE ? 0 : 1][move.srcRow * 8 + move.srcCol][move.destRow * 8 + move.destCol];
+    bonus = std::max(-MAX_SCORE, std::min(bonus, (int)MAX_SCORE));
+    // The closer a score already is to the limit, the less the same bonus moves it
+    score += bonus - score * std::abs(bonus) / MAX_SCORE;
+}
+
+MovePicker::MovePicker(const Board& board, PieceColor color, const Move& hashMove, const Move* killers,
+    const Move& counterMove, const ButterflyHistory* history)
+    : board(board), color(color), hashMove(hashMove), counterMove(counterMove), history(history), capturesOnly(false),
+    stage(Stage::HASH_MOVE), index(0), badCaptureCount(0) {
+    if (killers) {
+        this->killers[0] = killers[0];
+        this->killers[1] = killers[1];
+    }
+
+    // A hash move from another position (or a stale killer) must not be played here
+    if (!isNone(this->hashMove) && !isPlayable(board, color, this->hashMove)) {
+        this->hashMove = Move();
+    }
+}
+
+MovePicker::MovePicker(const Board& board, PieceColor color)
+    : board(board), color(color), history(nullptr), capturesOnly(true), stage(Stage::GENERATE_CAPTURES), index(0), badCaptureCount(0) {
+}
+
+// Moves already handed out by the hash move, killer and countermove stages, skipped when their stage comes up again
+bool MovePicker::isSpecialMove(const Move& move) const {
+    return (!isNone(hashMove) && move == hashMove) || (!isNone(killers[0]) && move == killers[0]) ||
+        (!isNone(killers[1]) && move == killers[1]) || (!isNone(counterMove) && move == counterMove);
+}
+
+// Killers and countermoves were quiet moves somewhere else in the tree, so they must be legal and still quiet here
+bool MovePicker::isPlayableQuiet(const Move& move) const {
+    return board.isEmpty(move.destRow, move.destCol) && move.promotionPiece == PieceType::EMPTY &&
+        move.flags != MoveType::EN_PASSANT && isPlayable(board, color, move);
+}
+
+// MVV-LVA: the victim's value dominates, the attacker's only breaks ties. Promotions count as winning the new piece
+void MovePicker::scoreCaptures() {
+    for (int i = 0; i < moves.size(); ++i) {
+        const Move& move = moves[i];
+        PieceType victim = move.flags == MoveType::EN_PASSANT ? PieceType::PAWN : board.getPieceType(move.destRow, move.destCol);
+        PieceType attacker = board.getPieceType(move.srcRow, move.srcCol);
+        scores[i] = Evaluation::pieceValue(victim) * 8 + Evaluation::pieceValue(move.promotionPiece) * 8 -
+            Evaluation::pieceValue(attacker) / 100;
+    }
+}
+
+void MovePicker::scoreQuiets() {
+    for (int i = index; i < moves.size(); ++i) {
+        scores[i] = history ? history->get(color, moves[i]) : 0;
+    }
+}
+
+// Swaps the highest scored remaining move to the current index and returns it. Selection beats a
+// full sort since most nodes only look at the first few moves
+const Move& MovePicker::pickBest() {
+    int best = index;
+    for (int i = index + 1; i < moves.size(); ++i) {
+        if (scores[i] > scores[best]) {
+            best = i;
+        }
+    }
+    if (best != index) {
+        std::swap(moves[best], moves[index]);
+        std::swap(scores[best], scores[index]);
+    }
+    return moves[index++];
+}
+
+bool MovePicker::next(Move& move) {
+    while (true) {
+        switch (stage) {
+        case Stage::HASH_MOVE:
+            stage = Stage::GENERATE_CAPTURES;
+            if (!isNone(hashMove)) {
+                move = hashMove;
+                return true;
+            }
+            break;
+
+        case Stage::GENERATE_CAPTURES:
+            moves.clear();
+            generateLegalMoves(board, color, moves, GenType::CAPTURES);
+            scoreCaptures();
+            index = 0;
+            stage = Stage::CAPTURES;
+            break;
+
+        case Stage::CAPTURES:
+            while (index < moves.size()) {
+                int current = index;
+                const Move& capture = pickBest();
+                if (!isNone(hashMove) && capture == hashMove) {
+                    continue;
+                }
+                // Losing captures wait until after the quiet moves, the quiescence search drops them
+                if (!seeGreaterOrEqual(board, capture, 0)) {
+                    std::swap(moves[current], moves[badCaptureCount++]);
+                    continue;
+                }
+                move = capture;
+                return true;
+            }
+            index = 0;
+            stage = capturesOnly ? Stage::DONE : Stage::KILLERS;
+            break;
+
+        case Stage::KILLERS:
+            // Killers are quiet moves that caused a cutoff at this ply elsewhere in the tree,
+            // so they must be legal, quiet and not the hash move to be tried here
+            while (index < 2) {
+                const Move& killer = killers[index++];
+                if (isNone(killer) || (!isNone(hashMove) && killer == hashMove)) {
+                    continue;
+                }
+                if (index == 2 && killer == killers[0]) {
+                    continue;
+                }
+                if (isPlayableQuiet(killer)) {
+                    move = killer;
+                    return true;
+                }
+                // Not playable here, make sure the quiet stage doesn't skip it
+                killers[index - 1] = Move();
+            }
+            stage = Stage::COUNTER_MOVE;
+            break;
+
+        case Stage::COUNTER_MOVE:
+            // The quiet move that last refuted the opponent's previous move
+            stage = Stage::GENERATE_QUIETS;
+            if (isNone(counterMove) || (!isNone(hashMove) && counterMove == hashMove) ||
+                counterMove == killers[0] || counterMove == killers[1]) {
+                break; // Nothing new to try, a repeat has already been handed out
+            }
+            if (isPlayableQuiet(counterMove)) {
+                move = counterMove;
+                return true;
+            }
+            counterMove = Move();
+            break;
+
+        case Stage::GENERATE_QUIETS:
+            // Appended after the captures, so the losing ones at the front are still there for the last stage
+            index = moves.size();
+            generateLegalMoves(board, color, moves, GenType::QUIETS);
+            scoreQuiets();
+            stage = Stage::QUIETS;
+            break;
+
+        case Stage::QUIETS:
+            while (index < moves.size()) {
+                const Move& quiet = pickBest();
+                if (!isSpecialMove(quiet)) {
+                    move = quiet;
+                    return true;
+                }
+            }
+            index = 0;
+            stage = Stage::BAD_CAPTURES;
+            break;
+
+        case Stage::BAD_CAPTURES:
+            if (index < badCaptureCount) {
+                move = moves[index++];
+                return true;
+            }
+            stage = Stage::DONE;
+            break;
+
+        case Stage::DONE:
+            return false;
+        }
+    }
+}
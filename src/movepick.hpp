@@ -0,0 +1,80 @@
+#ifndef MOVEPICK_HPP
+#define MOVEPICK_HPP
+
+#include "board.hpp"
+#include "move.hpp"
+#include "movegen.hpp"
+
+// Butterfly history: per side and from/to square pair, how much a quiet move has been causing beta
+// cutoffs lately. Updates pull scores towards +-MAX_SCORE, so they stay bounded and recent results count most
+class ButterflyHistory {
+public:
+	static const int MAX_SCORE = 16384;
+
+	ButterflyHistory() { clear(); }
+
+	void clear();
+	// Halves every score, so results from earlier searches fade
+	void age();
+
+	int get(PieceColor color, const Move& move) const {
+		return table[color == PieceColor::WHITE ? 0 : 1][move.srcRow * 8 + move.srcCol][move.destRow * 8 + move.destCol];
+	}
+	// Positive bonus for a move that caused a cutoff, negative for one searched before it that didn't
+	void update(PieceColor color, const Move& move, int bonus);
+
+private:
+	int table[2][64][64];
+};
+
+// Hands out the moves of a position one at a time, in stages: the hash move, then captures that
+// don't lose material by SEE (most valuable victim, least valuable attacker first), then the killer
+// moves and the countermove, then the remaining quiet moves by history score, then the losing captures. Each stage is only generated once
+// the previous one is used up, so a node that cuts off early never pays for quiet move generation.
+class MovePicker {
+public:
+	// hashMove and counterMove may be a default Move (none); killers points at two killer slots or is null,
+	// and without a history table quiet moves come in generation order
+	MovePicker(const Board& board, PieceColor color, const Move& hashMove, const Move* killers,
+		const Move& counterMove = Move(), const ButterflyHistory* history = nullptr);
+	// Captures and promotions that don't lose material, for the quiescence search
+	MovePicker(const Board& board, PieceColor color);
+
+	// Stores the next move and returns true, or returns false once every stage is exhausted
+	bool next(Move& move);
+
+private:
+	enum class Stage {
+		HASH_MOVE,
+		GENERATE_CAPTURES,
+		CAPTURES,
+		KILLERS,
+		COUNTER_MOVE,
+		GENERATE_QUIETS,
+		QUIETS,
+		BAD_CAPTURES,
+		DONE
+	};
+
+	const Board& board;
+	PieceColor color;
+	Move hashMove;
+	Move killers[2];
+	Move counterMove;
+	const ButterflyHistory* history;
+	bool capturesOnly;
+
+	Stage stage;
+	MoveList moves;
+	int scores[MoveList::MAX_MOVES];
+	int index;
+	int badCaptureCount; // Losing captures are kept at the front of the list, over captures already handed out
+
+	bool isSpecialMove(const Move& move) const;
+	bool isPlayableQuiet(const Move& move) const;
+	void scoreCaptures();
+	void scoreQuiets();
+	const Move& pickBest();
+};
+
+#endif // MOVEPICK_HPP
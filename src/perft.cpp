@@ -0,0 +1,202 @@
+#include "perft.hpp"
+#include "movegen.hpp"
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+PerftTable::PerftTable(size_t megabytes) : mask(0) {
+    size_t maxEntries = megabytes * 1024 * 1024 / sizeof(Entry);
+
+    // Round down to a power of two so the index is a mask of the key
+    size_t count = 1;
+    while (count * 2 <= maxEntries) {
+        count *= 2;
+    }
+
+    entries.reset(new Entry[count]);
+    for (size_t i = 0; i < count; ++i) {
+        entries[i].check.store(0, std::memory_order_relaxed);
+        entries[i].data.store(0, std::memory_order_relaxed);
+    }
+    mask = count - 1;
+}
+
+bool PerftTable::probe(uint64_t key, int depth, uint64_t& nodes) const {
+    const Entry& entry = entryFor(key, depth);
+    uint64_t data = entry.data.load(std::memory_order_relaxed);
+    uint64_t check = entry.check.load(std::memory_order_relaxed);
+
+    if ((check ^ data) != key || (int)(data & 0xFF) != depth) {
+        return false;
+    }
+    nodes = data >> 8;
+    return true;
+}
+
+void PerftTable::store(uint64_t key, int depth, uint64_t nodes) {
+    Entry& entry = entryFor(key, depth);
+    uint64_t data = (nodes << 8) | (uint64_t)(depth & 0xFF);
+    entry.check.store(key ^ data, std::memory_order_relaxed);
+    entry.data.store(data, std::memory_order_relaxed);
+}
+
+uint64_t perft(Board& board, int depth) {
+    return perft(board, depth, nullptr);
+}
+
+uint64_t perft(Board& board, int depth, PerftTable* table) {
+    if (depth <= 0) {
+        return 1;
+    }
+
+    uint64_t nodes = 0;
+    if (table && depth >= 2 && table->probe(board.getHashKey(), depth, nodes)) {
+        return nodes;
+    }
+
+    MoveList moves;
+    generateLegalMoves(board, board.getSideToMove(), moves);
+
+    // Bulk counting: every legal move at the last ply is one leaf
+    if (depth == 1) {
+        return (uint64_t)moves.size();
+    }
+
+    for (const Move& move : moves) {
+        board.makeMove(move);
+        nodes += perft(board, depth - 1, table);
+        board.unmakeMove();
+    }
+
+    if (table) {
+        table->store(board.getHashKey(), depth, nodes);
+    }
+    return nodes;
+}
+
+// One unit of work for the thread pool: a root move, and with more than one thread
+// and enough depth a reply to it, so a few big root subtrees don't leave threads idle
+struct PerftTask {
+    int rootIndex;
+    bool hasReply;
+    Move reply;
+};
+
+PerftResult perftDivide(Board& board, int depth, const PerftOptions& options) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::unique_ptr<PerftTable> table;
+    if (options.hashSizeMB > 0) {
+        table.reset(new PerftTable(options.hashSizeMB));
+    }
+
+    MoveList moves;
+    generateLegalMoves(board, board.getSideToMove(), moves);
+
+    int threadCount = options.threads > 1 ? options.threads : 1;
+    bool splitReplies = threadCount > 1 && depth >= 3;
+
+    std::vector<PerftTask> tasks;
+    for (int i = 0; i < moves.size(); ++i) {
+        if (!splitReplies) {
+            tasks.push_back({ i, false, Move() });
+            continue;
+        }
+
+        const Move& move = moves[i];
+        board.makeMove(move);
+        MoveList replies;
+        generateLegalMoves(board, board.getSideToMove(), replies);
+        board.unmakeMove();
+
+        for (const Move& reply : replies) {
+            tasks.push_back({ i, true, reply });
+        }
+    }
+
+    // Every worker takes the next task from a shared counter and searches it on its own copy of the board
+    std::vector<uint64_t> taskNodes(tasks.size(), 0);
+    std::atomic<size_t> nextTask(0);
+    auto worker = [&]() {
+        Board local = board;
+        for (;;) {
+            size_t index = nextTask.fetch_add(1);
+            if (index >= tasks.size()) {
+                break;
+            }
+
+            const PerftTask& task = tasks[index];
+            const Move& move = moves[task.rootIndex];
+            local.makeMove(move);
+            if (task.hasReply) {
+                local.makeMove(task.reply);
+                taskNodes[index] = perft(local, depth - 2, table.get());
+                local.unmakeMove();
+            }
+            else {
+                taskNodes[index] = perft(local, depth - 1, table.get());
+            }
+            local.unmakeMove();
+        }
+    };
+
+    if (threadCount == 1) {
+        worker();
+    }
+    else {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < threadCount; ++i) {
+            threads.emplace_back(worker);
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
+    std::vector<uint64_t> rootNodes(moves.size(), 0);
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        rootNodes[tasks[i].rootIndex] += taskNodes[i];
+    }
+
+    uint64_t total = 0;
+    for (int i = 0; i < moves.size(); ++i) {
+        total += rootNodes[i];
+        if (options.printDivide) {
+            std::cout << moveToString(moves[i]) << ": " << rootNodes[i] << std::endl;
+        }
+    }
+
+    PerftResult result;
+    result.nodes = depth > 0 ? total : 1;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::endl;
+    std::cout << "Nodes: " << result.nodes << std::endl;
+    std::cout << "Time: " << result.seconds << " s" << std::endl;
+    std::cout << "Nodes per second: " << result.nodesPerSecond() << std::endl;
+    return result;
+}
+
+std::string moveToString(const Move& move) {
+    int destCol = move.destCol;
+    // The engine encodes castling as the king moving onto its own rook
+    if (move.flags == MoveType::CASTLING) {
+        destCol = (move.destCol > move.srcCol) ? 6 : 2;
+    }
+
+    std::string text;
+    text += (char)('a' + move.srcCol);
+    text += (char)('8' - move.srcRow);
+    text += (char)('a' + destCol);
+    text += (char)('8' - move.destRow);
+
+    switch (move.promotionPiece) {
+    case PieceType::QUEEN: text += 'q'; break;
+    case PieceType::ROOK: text += 'r'; break;
+    case PieceType::BISHOP: text += 'b'; break;
+    case PieceType::KNIGHT: text += 'n'; break;
+    default: break;
+    }
+    return text;
+}
@@ -0,0 +1,60 @@
+#ifndef PERFT_HPP
+#define PERFT_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "board.hpp"
+#include "move.hpp"
+
+struct PerftResult {
+	uint64_t nodes;
+	double seconds;
+
+	uint64_t nodesPerSecond() const { return seconds > 0 ? (uint64_t)(nodes / seconds) : 0; }
+};
+
+struct PerftOptions {
+	int threads = 1;         // Worker threads the root moves (or root move/reply pairs) are split across
+	size_t hashSizeMB = 0;   // Size of the shared subtree count table, 0 to run without one
+	bool printDivide = true; // Print the count under every root move
+};
+
+// Shared (Zobrist key, depth) -> node count table. Lock-free: each entry stores the key XORed with
+// its data, so an entry torn by two threads writing at once fails the key check instead of giving a wrong count
+class PerftTable {
+public:
+	explicit PerftTable(size_t megabytes);
+
+	bool probe(uint64_t key, int depth, uint64_t& nodes) const;
+	void store(uint64_t key, int depth, uint64_t nodes);
+
+private:
+	struct Entry {
+		std::atomic<uint64_t> check; // key ^ data
+		std::atomic<uint64_t> data;  // nodes << 8 | depth
+	};
+
+	std::unique_ptr<Entry[]> entries;
+	uint64_t mask;
+
+	Entry& entryFor(uint64_t key, int depth) const { return entries[(key ^ ((uint64_t)depth * 0x9E3779B97F4A7C15ULL)) & mask]; }
+};
+
+// Counts the leaf nodes of the legal move tree to the given depth, moving first with the side to move.
+// The last ply is counted in bulk from the size of the legal move list instead of making each move
+uint64_t perft(Board& board, int depth);
+
+// Same count, reusing subtree counts from the table (if not null) for every depth of 2 or more
+uint64_t perft(Board& board, int depth, PerftTable* table);
+
+// Perft split by root move: prints the node count under every root move (when printDivide is set),
+// then the total, elapsed time and nodes per second
+PerftResult perftDivide(Board& board, int depth, const PerftOptions& options = PerftOptions());
+
+// Coordinate notation (e2e4, e7e8q). Castling is written as the king's two-square move (e1g1)
+std::string moveToString(const Move& move);
+
+#endif // PERFT_HPP
@@ -6,22 +6,7 @@
 #include <vector>
 #include <string>
 #include <SDL_ttf.h>
-
-enum class PieceType {
-	PAWN,
-	ROOK,
-	KNIGHT,
-	BISHOP,
-	QUEEN,
-	KING,
-	EMPTY
-};
-
-enum class PieceColor {
-	WHITE,
-	BLACK,
-	EMPTY
-};
+#include "types.hpp"
 
 class Piece {
 public:
@@ -1,89 +1,777 @@
 #include "search.hpp"
 #include "movegen.hpp"
+#include "movepick.hpp"
 #include "eval.hpp"
 #include "ai.hpp"
+#include "attacks.hpp"
 #include "board.hpp"
-#include <limits>
-#include "board.hpp"
+#include "log.hpp"
+#include "see.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+
+// Mate scores are stored relative to the node rather than the root, so they stay correct
+// when the same position is reached at a different ply
+static int scoreToTT(int score, int ply) {
+    if (score >= Search::MATE_BOUND) {
+        return score + ply;
+    }
+    if (score <= -Search::MATE_BOUND) {
+        return score - ply;
+    }
+    return score;
+}
+
+static int scoreFromTT(int score, int ply) {
+    if (score >= Search::MATE_BOUND) {
+        return score - ply;
+    }
+    if (score <= -Search::MATE_BOUND) {
+        return score + ply;
+    }
+    return score;
+}
+
+// Material of the color's knights, bishops, rooks and queens
+static int pieceMaterial(const Board& board, PieceColor color) {
+    int material = 0;
+    for (PieceType pieceType : { PieceType::KNIGHT, PieceType::BISHOP, PieceType::ROOK, PieceType::QUEEN }) {
+        material += popCount(board.getPieces(pieceType, color)) * Evaluation::pieceValue(pieceType);
+    }
+    return material;
+}
+
+Search::Search(size_t hashSizeMB) : Search(std::make_shared<TranspositionTable>(hashSizeMB), 0) {
+}
+
+Search::Search(std::shared_ptr<TranspositionTable> table, int threadIndex) : tt(table), softTimeMs(0), hardTimeMs(0),
+    stopRequested(false), stopped(false), nullMoveMinPly(0), rootDepth(0), threadIndex(threadIndex) {
+    for (int ply = 0; ply < MAX_PLY; ++ply) {
+        killers[ply][0] = Move();
+        killers[ply][1] = Move();
+    }
+    setParams(SearchParams());
+}
+
+void Search::setThreads(int count) {
+    count = std::max(count, 1);
+    helpers.resize(count - 1);
+    for (int i = 0; i < count - 1; ++i) {
+        if (!helpers[i]) {
+            helpers[i].reset(new Search(tt, i + 1));
+        }
+    }
+}
+
+void Search::setParams(const SearchParams& searchParams) {
+    params = searchParams;
+
+    // Log-log table: reductions grow slowly with both the remaining depth and how late the move comes
+    for (int depth = 0; depth < MAX_PLY; ++depth) {
+        for (int moveNumber = 0; moveNumber < 64; ++moveNumber) {
+            reductions[depth][moveNumber] = 0;
+            if (depth > 0 && moveNumber > 0) {
+                double reduction = params.lmrBase + std::log((double)depth) * std::log((double)moveNumber) / params.lmrDivisor;
+                reductions[depth][moveNumber] = std::max(0, (int)reduction);
+            }
+        }
+    }
+}
+
+// Remember a quiet move that caused a cutoff, keeping the previous killer in the second slot
+void Search::storeKiller(const Move& move, int ply) {
+    if (ply >= MAX_PLY || move.flags != MoveType::QUIET || move.promotionPiece != PieceType::EMPTY) {
+        return;
+    }
+    if (killers[ply][0] != move) {
+        killers[ply][1] = killers[ply][0];
+        killers[ply][0] = move;
+    }
+}
+
+// Deep cutoffs say more about a move than shallow ones, up to a point
+static const int HISTORY_BONUS_LIMIT = 1200;
+
+static bool isQuiet(const Move& move) {
+    return move.flags != MoveType::CAPTURE && move.flags != MoveType::EN_PASSANT && move.promotionPiece == PieceType::EMPTY;
+}
+
+// A quiet move caused a beta cutoff: reward it, penalize the quiet moves searched before it without
+// success, and remember it as the answer to the move that led here
+void Search::updateQuietStats(PieceColor color, const Move& bestMove, int ply, int depth, const Move* quietsTried, int quietCount) {
+    storeKiller(bestMove, ply);
+
+    int bonus = std::min(depth * depth, HISTORY_BONUS_LIMIT);
+    history.update(color, bestMove, bonus);
+    for (int i = 0; i < quietCount; ++i) {
+        history.update(color, quietsTried[i], -bonus);
+    }
+
+    if (ply > 0 && moveStack[ply - 1].srcRow >= 0) {
+        const Move& previous = moveStack[ply - 1];
+        counterMoves[previous.srcRow * 8 + previous.srcCol][previous.destRow * 8 + previous.destCol] = bestMove;
+    }
+}
+
+// Turn the limits into a soft and a hard deadline for this move
+void Search::allocateTime() {
+    softTimeMs = 0;
+    hardTimeMs = 0;
+
+    if (limits.moveTimeMs > 0) {
+        softTimeMs = limits.moveTimeMs;
+        hardTimeMs = limits.moveTimeMs;
+    }
+    else if (limits.timeLeftMs > 0) {
+        // Spread the clock over the remaining moves (assume 30 in sudden death) plus most of the increment,
+        // never planning to use more than the clock minus a safety margin for overhead
+        int movesLeft = limits.movesToGo > 0 ? limits.movesToGo : 30;
+        int64_t safeTimeLeft = std::max<int64_t>(limits.timeLeftMs - 50, 1);
+        int64_t target = limits.timeLeftMs / movesLeft + limits.incrementMs * 3 / 4;
+
+        hardTimeMs = std::min<int64_t>(target * 3, safeTimeLeft);
+        softTimeMs = std::min<int64_t>(target, hardTimeMs);
+    }
+}
+
+int64_t Search::elapsedMs() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+// Checked at every node. The main thread always completes its first iteration, so there is a move to return
+bool Search::shouldStop() {
+    if (stopped) {
+        return true;
+    }
+    if (stats.completedDepth == 0 && threadIndex == 0) {
+        return false;
+    }
+
+    if (stopRequested.load(std::memory_order_relaxed) ||
+        (limits.nodes > 0 && stats.nodes >= limits.nodes) ||
+        (hardTimeMs > 0 && (stats.nodes & 1023) == 0 && elapsedMs() >= hardTimeMs)) {
+        stopped = true;
+    }
+    return stopped;
+}
 
 Move Search::alphaBetaSearch(Board& board, int depth) {
-    //Initial values for alpha and beta, representing the best possible scores for maximizing and minimizing player, respectively
-    int alpha = std::numeric_limits<int>::min();
-    int beta = std::numeric_limits<int>::max();
+    SearchLimits depthLimit;
+    depthLimit.depth = depth;
+    return search(board, depthLimit);
+}
+
+Move Search::search(Board& board, const SearchLimits& searchLimits) {
+    limits = searchLimits;
+    stats = SearchStats();
+    startTime = std::chrono::steady_clock::now();
+    stopRequested.store(false, std::memory_order_relaxed);
+    allocateTime();
+    tt->newSearch();
+
+    if (!hasAnyLegalMove(board, board.getSideToMove())) {
+        return Move();
+    }
+
+    // Lazy SMP: the helpers run the same iterative deepening on their own copies of the board and only share
+    // the hash table, which is what makes them useful to the main thread. They have no limits of their own,
+    // the main thread decides when to stop and which move to play
+    std::vector<std::thread> threads;
+    for (std::unique_ptr<Search>& helper : helpers) {
+        helper->limits = SearchLimits();
+        helper->limits.depth = limits.depth;
+        helper->stats = SearchStats();
+        helper->startTime = startTime;
+        helper->softTimeMs = 0;
+        helper->hardTimeMs = 0;
+        helper->stopRequested.store(false, std::memory_order_relaxed);
+        helper->setParams(params);
+        threads.emplace_back([worker = helper.get(), boardCopy = board]() mutable {
+            worker->iterativeDeepening(boardCopy);
+        });
+    }
+
+    Move bestMove = iterativeDeepening(board);
+
+    for (std::unique_ptr<Search>& helper : helpers) {
+        helper->stop();
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (std::unique_ptr<Search>& helper : helpers) {
+        stats.helperNodes += helper->stats.nodes;
+    }
+
+    stats.seconds = elapsedMs() / 1000.0;
+    LOG_DEBUG(SEARCH, "%d threads, %llu helper nodes", (int)helpers.size() + 1, (unsigned long long)stats.helperNodes);
+    LOG_DEBUG(SEARCH, "pruned: null move %llu, reverse futility %llu, razoring %llu, futility %llu, late moves %llu, see %llu",
+        (unsigned long long)stats.nullMoveCutoffs, (unsigned long long)stats.reverseFutilityPrunes,
+        (unsigned long long)stats.razorPrunes, (unsigned long long)stats.futilityPrunes,
+        (unsigned long long)stats.lateMovePrunes, (unsigned long long)stats.seePrunes);
+    LOG_DEBUG(SEARCH, "probcut %llu tries, %llu cutoffs, %llu failed; singular %llu searches, %llu extended, %llu failed",
+        (unsigned long long)stats.probCutTries, (unsigned long long)stats.probCutCutoffs,
+        (unsigned long long)stats.probCutFailures, (unsigned long long)stats.singularSearches,
+        (unsigned long long)stats.singularExtensions, (unsigned long long)stats.singularFailures);
+    return bestMove;
+}
 
-    PieceColor currentPlayerColor = board.getAIPlayer(); // AI is always the maximizing player
 
-    std::vector<Move> allMoves = generateAllMoves(board, currentPlayerColor);
+// Depth staggering for the helpers (indexed by helper number modulo 20): helper i skips an iteration whenever
+// (depth + SKIP_PHASE[i]) / SKIP_SIZE[i] is odd, so the helpers spread out over neighbouring depths instead
+// of all searching the same one
+static const int SKIP_SIZE[20] = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+static const int SKIP_PHASE[20] = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
 
+Move Search::iterativeDeepening(Board& board) {
+    bool mainThread = threadIndex == 0;
+    stopped = false;
+    nullMoveMinPly = 0;
+    history.age();
+
+    MoveList rootMoves;
+    generateLegalMoves(board, board.getSideToMove(), rootMoves);
+
+    //Fall back to the first legal move in case every move loses
     Move bestMove;
+    if (rootMoves.empty()) {
+        return bestMove;
+    }
 
-    //Perform alpha-beta search for each possible move
-    for (const Move& move : allMoves) {
-        Board tempBoard = board;
-        tempBoard.makeMove(move.srcRow, move.srcCol, move.destRow, move.destCol);
+    //Start with the move stored for this position, e.g. from pondering the previous move
+    TTEntry entry;
+    if (tt->probe(board.getHashKey(), entry) && !entry.packedMove().isNull()) {
+        moveToFront(rootMoves, entry.packedMove().toMove());
+    }
+    bestMove = rootMoves[0];
 
-        //Evaluate the position after making the move
-        int score = alphaBeta(tempBoard, depth - 1, alpha, beta, getOppositeColor(currentPlayerColor));
+    int maxDepth = (limits.depth > 0 && limits.depth < MAX_PLY) ? limits.depth : MAX_PLY - 1;
+    for (int depth = 1; depth <= maxDepth; ++depth) {
+        if (!mainThread) {
+            int i = (threadIndex - 1) % 20;
+            if (((depth + SKIP_PHASE[i]) / SKIP_SIZE[i]) % 2 != 0) {
+                continue;
+            }
+        }
 
-        if (score > alpha) {
-            alpha = score;
-            bestMove = move;
+        rootDepth = depth;
+        // From ASPIRATION_MIN_DEPTH on, search a narrow window around the last score first and
+        // widen it on the side that failed. Most iterations land inside and finish much faster
+        int delta = ASPIRATION_WINDOW;
+        int alpha = -INFINITE_SCORE;
+        int beta = INFINITE_SCORE;
+        if (depth >= ASPIRATION_MIN_DEPTH) {
+            alpha = std::max(stats.score - delta, -INFINITE_SCORE);
+            beta = std::min(stats.score + delta, (int)INFINITE_SCORE);
+        }
+
+        int score;
+        while (true) {
+            score = searchRoot(board, depth, alpha, beta, rootMoves);
+            if (stopped) {
+                break;
+            }
+
+            if (score <= alpha) {
+                beta = (alpha + beta) / 2;
+                alpha = std::max(score - delta, -INFINITE_SCORE);
+            }
+            else if (score >= beta) {
+                beta = std::min(score + delta, (int)INFINITE_SCORE);
+            }
+            else {
+                break;
+            }
+            delta *= 2;
+        }
+
+        if (stopped) {
+            break; // Aborted, keep the result of the last completed iteration
+        }
+
+        // searchRoot keeps the best move first, so the next iteration starts with it
+        bestMove = pvTable[0][0];
+        stats.completedDepth = depth;
+        stats.score = score;
+        stats.seconds = elapsedMs() / 1000.0;
+        stats.pv.assign(pvTable[0], pvTable[0] + pvLength[0]);
+
+        if (mainThread) {
+            LOG_INFO(SEARCH, "depth %d score %d nodes %llu time %.3f s pv length %d", depth, score,
+                (unsigned long long)stats.nodes, stats.seconds, pvLength[0]);
+        }
+
+        // A forced mate found within this depth won't change with more depth
+        if (std::abs(score) >= MATE_BOUND && MATE_SCORE - std::abs(score) <= depth) {
+            break;
+        }
+        if (softTimeMs > 0 && elapsedMs() >= softTimeMs) {
+            break;
         }
     }
+
     return bestMove;
 }
 
+void Search::moveToFront(MoveList& moves, const Move& move) {
+    for (int i = 0; i < moves.size(); ++i) {
+        if (moves[i] == move) {
+            std::rotate(moves.begin(), moves.begin() + i, moves.begin() + i + 1);
+            return;
+        }
+    }
+}
 
-int Search::alphaBeta(Board& board, int depth, int alpha, int beta, PieceColor maximizingPlayer) {
-    PieceColor color = board.getAIPlayer();
-    if (depth == 0 || board.isGameOver(color)) {
-        return Evaluation::evaluate(board, color); // Pass the AI player color for evaluation
+// The line below this ply is the move followed by the child's line
+void Search::updatePV(int ply, const Move& move) {
+    pvTable[ply][ply] = move;
+    for (int i = ply + 1; i < pvLength[ply + 1]; ++i) {
+        pvTable[ply][i] = pvTable[ply + 1][i];
     }
+    pvLength[ply] = std::max(pvLength[ply + 1], ply + 1);
+}
 
-    std::vector<Move> allMoves = generateAllMoves(board, maximizingPlayer);
+// One pass over the root moves within [alpha, beta]. The new best move is moved to the front of the list
+// as soon as it is found, so re-searches and the next iteration try it first. The result is meaningless
+// if the search was stopped
+int Search::searchRoot(Board& board, int depth, int alpha, int beta, MoveList& rootMoves) {
+    int originalAlpha = alpha;
+    int bestScore = -INFINITE_SCORE;
+    pvLength[0] = 0;
 
-    if (allMoves.empty()) {
-        // No moves available, either stalemate or checkmate
-        if (board.isInCheck(color)) { // Pass the AI player color for checking
-            // Checkmate, return a very negative score
-            return std::numeric_limits<int>::min();
+    for (int i = 0; i < rootMoves.size(); ++i) {
+        Move move = rootMoves[i];
+        moveStack[0] = move;
+        board.makeMove(move);
+
+        int score;
+        if (i == 0) {
+            score = -alphaBeta(board, depth - 1, -beta, -alpha, 1);
         }
         else {
-            // Stalemate, return a draw score
+            // Only the first move gets the full window, the rest just have to prove they are no better
+            score = -alphaBeta(board, depth - 1, -alpha - 1, -alpha, 1);
+            if (score > alpha && score < beta) {
+                score = -alphaBeta(board, depth - 1, -beta, -alpha, 1);
+            }
+        }
+        board.unmakeMove();
+
+        if (stopped) {
             return 0;
         }
+
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) {
+                alpha = score;
+                updatePV(0, move);
+                std::rotate(rootMoves.begin(), rootMoves.begin() + i, rootMoves.begin() + i + 1);
+                if (alpha >= beta) {
+                    break;
+                }
+            }
+        }
     }
 
-    if (maximizingPlayer == color) {
-        int maxEval = std::numeric_limits<int>::min();
+    Bound bound = bestScore <= originalAlpha ? Bound::UPPER : bestScore >= beta ? Bound::LOWER : Bound::EXACT;
+    tt->store(board.getHashKey(), depth, scoreToTT(bestScore, 0), bound,
+        bound == Bound::UPPER ? PackedMove() : PackedMove(rootMoves[0]));
+    return bestScore;
+}
+
+// Negamax principal variation search. Scores are from the point of view of the side to move, and
+// windows with beta - alpha > 1 are PV nodes that collect the expected line in the PV table
+int Search::alphaBeta(Board& board, int depth, int alpha, int beta, int ply) {
+    if (depth <= 0) {
+        return quiescence(board, alpha, beta, ply, 0);
+    }
 
-        for (const Move& move : allMoves) {
-            Board tempBoard = board;
-            tempBoard.makeMove(move.srcRow, move.srcCol, move.destRow, move.destCol);
-            int eval = alphaBeta(tempBoard, depth - 1, alpha, beta, getOppositeColor(maximizingPlayer));
-            maxEval = std::max(maxEval, eval);
-            alpha = std::max(alpha, eval);
+    bool pvNode = beta - alpha > 1;
+    pvLength[ply] = ply;
 
-            if (beta <= alpha) {
-                break;
+    ++stats.nodes;
+    if (shouldStop()) {
+        return 0; // Unwinding, the caller throws the result away
+    }
+
+    PieceColor sideToMove = board.getSideToMove();
+    if (ply >= MAX_PLY - 1) {
+        return Evaluation::evaluate(board, sideToMove);
+    }
+
+    // While a singular extension search leaves out the hash move this isn't the same node as the one in the
+    // table, so it neither takes hash cutoffs nor stores its result
+    const Move& excludedMove = excludedMoves[ply];
+    bool excluding = excludedMove.srcRow >= 0;
+
+    // PV nodes don't take hash cutoffs, so the PV table always holds a full line
+    uint64_t key = board.getHashKey();
+    Move hashMove;
+    TTEntry entry;
+    bool hashHit = tt->probe(key, entry);
+    if (hashHit) {
+        if (!entry.packedMove().isNull()) {
+            hashMove = entry.packedMove().toMove();
+        }
+        if (!pvNode && !excluding && entry.depth >= depth) {
+            int ttScore = scoreFromTT(entry.score, ply);
+            if (entry.bound() == Bound::EXACT ||
+                (entry.bound() == Bound::LOWER && ttScore >= beta) ||
+                (entry.bound() == Bound::UPPER && ttScore <= alpha)) {
+                return ttScore;
             }
         }
-        return maxEval;
     }
-    else {
-        int minEval = std::numeric_limits<int>::max();
 
-        for (const Move& move : allMoves) {
-            Board tempBoard = board;
-            tempBoard.makeMove(move.srcRow, move.srcCol, move.destRow, move.destCol);
-            int eval = alphaBeta(tempBoard, depth - 1, alpha, beta, getOppositeColor(maximizingPlayer));
-            minEval = std::min(minEval, eval);
-            beta = std::min(beta, eval);
+    bool inCheck = board.isInCheck(sideToMove);
+    int staticEval = inCheck ? -INFINITE_SCORE : Evaluation::evaluate(board, sideToMove);
 
-            if (beta <= alpha) {
-                break;
+    // Null-move pruning: if the opponent can't get back below beta even when moving twice in a row,
+    // a real move would almost certainly fail high too. Never twice in a row, and never without pieces
+    if (params.nullMove && !pvNode && !inCheck && !excluding && depth >= params.nullMoveMinDepth && ply >= nullMoveMinPly &&
+        staticEval >= beta && std::abs(beta) < MATE_BOUND && ply > 0 && moveStack[ply - 1].srcRow >= 0) {
+        int material = pieceMaterial(board, sideToMove);
+        if (material > 0) {
+            int reduction = params.nullMoveReduction + depth / params.nullMoveDepthDivisor;
+
+            moveStack[ply] = Move();
+            board.makeNullMove();
+            int score = -alphaBeta(board, depth - 1 - reduction, -beta, -beta + 1, ply + 1);
+            board.unmakeNullMove();
+
+            if (stopped) {
+                return 0;
+            }
+            if (score >= beta) {
+                // A mate found after passing doesn't prove anything
+                if (score >= MATE_BOUND) {
+                    score = beta;
+                }
+                if (material > params.nullMoveVerifyMaterial) {
+                    ++stats.nullMoveCutoffs;
+                    return score;
+                }
+
+                // Little material left, so zugzwang is a real risk. Check with a reduced search of the actual
+                // moves, with null moves turned off for the first plies of it
+                int previousMinPly = nullMoveMinPly;
+                nullMoveMinPly = ply + 3 * (depth - reduction) / 4 + 1;
+                int verified = alphaBeta(board, depth - reduction, beta - 1, beta, ply);
+                nullMoveMinPly = previousMinPly;
+
+                if (stopped) {
+                    return 0;
+                }
+                if (verified >= beta) {
+                    ++stats.nullMoveCutoffs;
+                    return score;
+                }
+            }
+        }
+    }
+
+    bool frontierNode = !pvNode && !inCheck && !excluding;
+
+    // Reverse futility: far enough above beta that no reply is going to bring the score back down
+    if (frontierNode && params.reverseFutility && depth <= params.reverseFutilityDepth && std::abs(beta) < MATE_BOUND &&
+        staticEval - params.reverseFutilityMargin * depth >= beta) {
+        ++stats.reverseFutilityPrunes;
+        return staticEval;
+    }
+
+    // Razoring: so far below alpha that only a capture could help, which the quiescence search will find
+    if (frontierNode && params.razoring && depth <= params.razorDepth && staticEval + params.razorMargin * depth < alpha) {
+        int score = quiescence(board, alpha, alpha + 1, ply, 0);
+        if (stopped) {
+            return 0;
+        }
+        if (score <= alpha) {
+            ++stats.razorPrunes;
+            return score;
+        }
+    }
+
+    // ProbCut: a good capture that beats beta by a margin even in a much shallower search almost
+    // certainly fails high at full depth too. Not worth trying if the table already says it won't work
+    int probCutBeta = beta + params.probCutMargin;
+    if (params.probCut && !pvNode && !inCheck && !excluding && depth >= params.probCutDepth && std::abs(beta) < MATE_BOUND &&
+        !(hashHit && entry.depth >= depth - params.probCutReduction + 1 && scoreFromTT(entry.score, ply) < probCutBeta)) {
+        MovePicker capturePicker(board, sideToMove);
+        Move capture;
+        while (capturePicker.next(capture)) {
+            if (!seeGreaterOrEqual(board, capture, probCutBeta - staticEval)) {
+                continue;
+            }
+
+            moveStack[ply] = capture;
+            board.makeMove(capture);
+            // A quiescence search first weeds out captures that don't even hold up there
+            int score = -quiescence(board, -probCutBeta, -probCutBeta + 1, ply + 1, 0);
+            if (score >= probCutBeta && !stopped) {
+                ++stats.probCutTries;
+                score = -alphaBeta(board, depth - params.probCutReduction, -probCutBeta, -probCutBeta + 1, ply + 1);
+                if (score < probCutBeta && !stopped) {
+                    ++stats.probCutFailures;
+                }
+            }
+            board.unmakeMove();
+
+            if (stopped) {
+                return 0;
+            }
+            if (score >= probCutBeta) {
+                ++stats.probCutCutoffs;
+                tt->store(key, depth - params.probCutReduction + 1, scoreToTT(score, ply), Bound::LOWER, PackedMove(capture));
+                return score;
             }
         }
-        return minEval;
     }
+
+    int originalAlpha = alpha;
+
+    // Singular extension candidate: a hash move that failed high (or was exact) not much shallower than this.
+    // Extensions stop at twice the iteration depth so they can't run away
+    bool singularCandidate = params.singularExtensions && !excluding && depth >= params.singularDepth &&
+        ply < 2 * rootDepth && hashHit && hashMove.srcRow >= 0 && entry.depth >= depth - 3 &&
+        (entry.bound() == Bound::LOWER || entry.bound() == Bound::EXACT) &&
+        std::abs(scoreFromTT(entry.score, ply)) < MATE_BOUND;
+
+    Move counterMove;
+    if (ply > 0 && moveStack[ply - 1].srcRow >= 0) {
+        const Move& previous = moveStack[ply - 1];
+        counterMove = counterMoves[previous.srcRow * 8 + previous.srcCol][previous.destRow * 8 + previous.destCol];
+    }
+
+    // Moves come from the staged picker, so quiet moves are only generated if the hash move,
+    // a capture, a killer or the countermove doesn't cut the node off first
+    MovePicker picker(board, sideToMove, hashMove, killers[ply], counterMove, &history);
+    Move move;
+    Move bestMove;
+    int bestScore = -INFINITE_SCORE;
+    int movesSearched = 0;
+
+    // Quiet moves that didn't cause a cutoff, their history is lowered when a later one does
+    Move quietsTried[64];
+    int quietCount = 0;
+
+    // Futility pruning needs the static eval to be this far below alpha
+    bool futile = frontierNode && params.futility && depth <= params.futilityDepth &&
+        staticEval + params.futilityMargin * depth <= alpha;
+    int lateMoveCount = params.lmpBase + depth * depth;
+
+    while (picker.next(move)) {
+        if (excluding && move == excludedMove) {
+            continue;
+        }
+
+        // Is the hash move the only good move here? Search everything else at half depth against a bound
+        // just below the hash score; if nothing reaches it, the hash move gets an extra ply
+        int extension = 0;
+        if (singularCandidate && move == hashMove) {
+            int singularBeta = scoreFromTT(entry.score, ply) - params.singularMargin * depth;
+            ++stats.singularSearches;
+
+            excludedMoves[ply] = move;
+            int score = alphaBeta(board, (depth - 1) / 2, singularBeta - 1, singularBeta, ply);
+            excludedMoves[ply] = Move();
+
+            if (stopped) {
+                return 0;
+            }
+            if (score < singularBeta) {
+                ++stats.singularExtensions;
+                extension = 1;
+            }
+            else {
+                ++stats.singularFailures;
+            }
+        }
+
+        // Shallow quiet moves that can't matter are skipped, as long as one move has been searched and isn't getting mated
+        bool quiet = isQuiet(move);
+        bool prunable = frontierNode && quiet && movesSearched > 0 && bestScore > -MATE_BOUND;
+        if (prunable && params.lateMovePruning && depth <= params.lmpDepth) {
+            if (quietCount >= lateMoveCount) {
+                ++stats.lateMovePrunes;
+                continue;
+            }
+            if (!seeGreaterOrEqual(board, move, -params.seeQuietMargin * depth)) {
+                ++stats.seePrunes;
+                continue;
+            }
+        }
+
+        // Decided before the move is made, so a futile move costs no make/unmake
+        bool givesCheck = isCheckingMove(board, move);
+        if (prunable && futile && !givesCheck) {
+            ++stats.futilityPrunes;
+            continue;
+        }
+
+        moveStack[ply] = move;
+        board.makeMove(move);
+
+        int newDepth = depth - 1 + extension;
+        int score;
+        if (movesSearched == 0) {
+            score = -alphaBeta(board, newDepth, -beta, -alpha, ply + 1);
+        }
+        else {
+            // Late quiet moves rarely turn out best, so they get a shallower null-window search first.
+            // Checks, evasions and the moves the ordering singled out are never reduced
+            int reduction = 0;
+            if (params.lateMoveReductions && depth >= params.lmrMinDepth && movesSearched >= params.lmrMinMoves &&
+                quiet && !inCheck && !givesCheck && move != killers[ply][0] && move != killers[ply][1] &&
+                move != counterMove) {
+                reduction = reductions[std::min(depth, MAX_PLY - 1)][std::min(movesSearched, 63)];
+                if (pvNode) {
+                    --reduction;
+                }
+                reduction = std::max(0, std::min(reduction, depth - 2));
+            }
+
+            // Null window first; a reduced move that beats alpha is searched again at full depth,
+            // and only a move that still beats alpha inside a PV node gets the full window
+            score = -alphaBeta(board, newDepth - reduction, -alpha - 1, -alpha, ply + 1);
+            if (reduction > 0 && score > alpha) {
+                score = -alphaBeta(board, newDepth, -alpha - 1, -alpha, ply + 1);
+            }
+            if (score > alpha && score < beta) {
+                score = -alphaBeta(board, newDepth, -beta, -alpha, ply + 1);
+            }
+        }
+        board.unmakeMove();
+
+        if (stopped) {
+            break;
+        }
+        ++movesSearched;
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = move;
+            if (score > alpha) {
+                alpha = score;
+                if (pvNode) {
+                    updatePV(ply, move);
+                }
+                if (alpha >= beta) {
+                    if (quiet) {
+                        updateQuietStats(sideToMove, move, ply, depth, quietsTried, quietCount);
+                    }
+                    break;
+                }
+            }
+        }
+
+        if (quiet && quietCount < 64) {
+            quietsTried[quietCount++] = move;
+        }
+    }
+
+    // Results of an aborted search are incomplete, keep them out of the table
+    if (stopped) {
+        return 0;
+    }
+
+    if (excluding) {
+        // Only its own bound matters to the singular test, and with the hash move left out an empty node isn't mate
+        return movesSearched == 0 ? alpha : bestScore;
+    }
+
+    if (movesSearched == 0) {
+        // No legal moves available, checkmate scores the distance from the root so shorter mates are preferred
+        bestScore = inCheck ? -(MATE_SCORE - ply) : 0;
+        tt->store(key, depth, scoreToTT(bestScore, ply), Bound::EXACT, PackedMove());
+        return bestScore;
+    }
+
+    Bound bound = Bound::EXACT;
+    if (bestScore <= originalAlpha) {
+        bound = Bound::UPPER;
+    }
+    else if (bestScore >= beta) {
+        bound = Bound::LOWER;
+    }
+
+    // When every move failed low none of them is known to be best, so keep the stored move
+    tt->store(key, depth, scoreToTT(bestScore, ply), bound, bound == Bound::UPPER ? PackedMove() : PackedMove(bestMove));
+
+    return bestScore;
+}
+
+int Search::quiescence(Board& board, int alpha, int beta, int ply, int qply) {
+    pvLength[ply] = ply;
+
+    ++stats.nodes;
+    if (shouldStop()) {
+        return 0;
+    }
+
+    PieceColor sideToMove = board.getSideToMove();
+    if (ply >= MAX_PLY - 1) {
+        return Evaluation::evaluate(board, sideToMove);
+    }
+
+    // In check at the first ply standing pat isn't an option, every evasion is searched and having none is mate.
+    // Deeper down a check is only answered by captures, which keeps the search from running away
+    bool evasions = params.quiescenceEvasions && qply == 0 && board.isInCheck(sideToMove);
+
+    int standPat = -INFINITE_SCORE;
+    if (!evasions) {
+        // The side to move can usually do at least as well as the static score by not capturing
+        standPat = Evaluation::evaluate(board, sideToMove);
+        if (standPat >= beta) {
+            return standPat;
+        }
+        // Not even winning a queen would get back to alpha
+        if (standPat + Evaluation::pieceValue(PieceType::QUEEN) + DELTA_MARGIN < alpha) {
+            return standPat;
+        }
+        alpha = std::max(alpha, standPat);
+    }
+
+    // The captures-only picker already leaves out captures that lose material by SEE
+    MovePicker picker = evasions ? MovePicker(board, sideToMove, Move(), nullptr) : MovePicker(board, sideToMove);
+    Move move;
+    int bestScore = standPat;
+    int movesSearched = 0;
+
+    while (picker.next(move)) {
+        if (!evasions && move.promotionPiece == PieceType::EMPTY) {
+            // Delta pruning: skip captures that can't raise the score to alpha
+            PieceType captured = move.flags == MoveType::EN_PASSANT ? PieceType::PAWN : board.getPieceType(move.destRow, move.destCol);
+            if (standPat + Evaluation::pieceValue(captured) + DELTA_MARGIN <= alpha) {
+                continue;
+            }
+        }
+
+        board.makeMove(move);
+        int score = -quiescence(board, -beta, -alpha, ply + 1, qply + 1);
+        board.unmakeMove();
+
+        if (stopped) {
+            return 0;
+        }
+        ++movesSearched;
+
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) {
+                alpha = score;
+                if (alpha >= beta) {
+                    break;
+                }
+            }
+        }
+    }
+
+    if (evasions && movesSearched == 0) {
+        return -(MATE_SCORE - ply);
+    }
+
+    return bestScore;
 }
@@ -1,13 +1,205 @@
 #ifndef SEARCH_HPP
 #define SEARCH_HPP
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
 #include "board.hpp"
 #include "move.hpp"
+#include "movepick.hpp"
+#include "tt.hpp"
+
+// When to stop searching. Zero means no limit; with no limits at all the search runs to MAX_PLY
+// (or until stop() is called). The first iteration always completes, so there is always a move
+struct SearchLimits {
+	int depth = 0;        // Deepest iteration to run
+	int moveTimeMs = 0;   // Fixed time for this move
+	int timeLeftMs = 0;   // Time left on the AI's clock, a share of it is spent on this move
+	int incrementMs = 0;  // Increment added to the clock after each move
+	int movesToGo = 0;    // Moves until the next time control, 0 for sudden death
+	uint64_t nodes = 0;   // Node budget
+};
+
+// What the last search did
+struct SearchStats {
+	uint64_t nodes = 0;
+	int completedDepth = 0; // Deepest iteration that finished
+	int score = 0;          // Score of that iteration, from the point of view of the side to move
+	double seconds = 0;
+	std::vector<Move> pv;   // Expected line from the root, starting with the best move
+	uint64_t helperNodes = 0; // Nodes searched by the helper threads, on top of nodes
+
+	// How often each kind of selective pruning fired
+	uint64_t nullMoveCutoffs = 0;
+	uint64_t reverseFutilityPrunes = 0;  // Nodes cut because the static eval was far above beta
+	uint64_t razorPrunes = 0;            // Nodes resolved by quiescence because the static eval was far below alpha
+	uint64_t futilityPrunes = 0;         // Quiet moves skipped that couldn't raise the score to alpha
+	uint64_t lateMovePrunes = 0;         // Quiet moves skipped for coming late in the list
+	uint64_t seePrunes = 0;              // Quiet moves skipped for losing material by SEE
+
+	uint64_t probCutTries = 0;           // Captures that passed the SEE and quiescence filters and got a reduced search
+	uint64_t probCutCutoffs = 0;
+	uint64_t probCutFailures = 0;        // Reduced searches that didn't confirm the cutoff
+	uint64_t singularSearches = 0;       // Hash moves tested for being singular
+	uint64_t singularExtensions = 0;
+	uint64_t singularFailures = 0;       // Another move also reached the singular bound, no extension
+};
+
+// Selective search settings. Depths are in plies, material in centipawns
+struct SearchParams {
+	// Answer a check at the first quiescence ply with every evasion instead of standing pat
+	bool quiescenceEvasions = true;
+
+	// Null-move pruning: let the opponent move twice, and if a reduced search still fails high the node
+	// is cut. The reduction is nullMoveReduction + depth / nullMoveDepthDivisor
+	bool nullMove = true;
+	int nullMoveMinDepth = 3;
+	int nullMoveReduction = 3;
+	int nullMoveDepthDivisor = 6;
+	// With no more than this much piece (non-pawn) material a null-move fail high is verified by a reduced
+	// normal search, since zugzwang gets likely. Without any pieces null moves are never tried
+	int nullMoveVerifyMaterial = 500;
+
+	// Late move reductions: quiet moves late in the list are searched with less depth first and only
+	// re-searched at full depth if they beat alpha. The reduction is lmrBase + ln(depth) * ln(moveNumber) / lmrDivisor
+	bool lateMoveReductions = true;
+	int lmrMinDepth = 3;
+	int lmrMinMoves = 3; // Moves searched at full depth before any reduction
+	double lmrBase = 0.75;
+	double lmrDivisor = 2.25;
+
+	// Frontier pruning at non-PV nodes that aren't in check, up to the given depths. Margins grow per ply of depth.
+	// Reverse futility: cut the node if the static eval beats beta by the margin
+	bool reverseFutility = true;
+	int reverseFutilityDepth = 6;
+	int reverseFutilityMargin = 80;
+	// Razoring: if the static eval is below alpha by the margin, let the quiescence search decide
+	bool razoring = true;
+	int razorDepth = 2;
+	int razorMargin = 300;
+	// Futility: skip quiet non-checking moves when the static eval plus the margin can't reach alpha
+	bool futility = true;
+	int futilityDepth = 3;
+	int futilityMargin = 120;
+	// Late-move-count pruning: skip the remaining quiet moves once lmpBase + depth^2 of them have been searched,
+	// and quiet moves that lose more than seeQuietMargin per ply of depth
+	bool lateMovePruning = true;
+	int lmpDepth = 3;
+	int lmpBase = 3;
+	int seeQuietMargin = 50;
+
+	// ProbCut: at non-PV nodes from probCutDepth on, a good capture whose search at probCutReduction plies less
+	// still beats beta + probCutMargin is taken as proof that the full-depth search would fail high
+	bool probCut = true;
+	int probCutDepth = 5;
+	int probCutMargin = 200;
+	int probCutReduction = 4;
+
+	// Singular extensions: from singularDepth on, the hash move (a lower bound or exact, from at most 3 plies
+	// shallower) is searched one ply deeper if every other move fails low against the hash score minus
+	// singularMargin per ply, in a search of half the depth
+	bool singularExtensions = true;
+	int singularDepth = 7;
+	int singularMargin = 2;
+};
 
 class Search {
 public:
+	static const int MAX_PLY = 64;
+
+	// Mate scores are MATE_SCORE minus the distance to mate in plies, so they fit in a TT entry
+	// and shorter mates score higher. Anything beyond MATE_BOUND is a mate score
+	static const int MATE_SCORE = 30000;
+	static const int MATE_BOUND = MATE_SCORE - 2 * MAX_PLY;
+	static const int INFINITE_SCORE = MATE_SCORE + 1;
+
+	// Aspiration windows start this wide around the previous score, from this depth on
+	static const int ASPIRATION_WINDOW = 25;
+	static const int ASPIRATION_MIN_DEPTH = 4;
+
+	// Quiescence search skips captures that can't lift the score to alpha even with this much to spare
+	static const int DELTA_MARGIN = 200;
+
+	explicit Search(size_t hashSizeMB = TranspositionTable::DEFAULT_SIZE_MB);
+
+	// Resize or empty the transposition table, e.g. between games. The helper threads share it
+	void setHashSize(size_t megabytes) { tt->resize(megabytes); }
+	void clearHash() { tt->clear(); }
+
+	// Threads used by search(), including the calling one. Extra threads are helpers sharing the hash table
+	void setThreads(int count);
+	int getThreads() const { return (int)helpers.size() + 1; }
+
+	// Takes effect from the next search
+	void setParams(const SearchParams& searchParams);
+	const SearchParams& getParams() const { return params; }
+
+	// Iterative deepening within the limits, for the side to move. Returns the best move of the last completed
+	// iteration, or no move (srcRow -1) if there is none
+	Move search(Board& board, const SearchLimits& limits);
+	// Fixed-depth search, the same as search() with only a depth limit
 	Move alphaBetaSearch(Board& board, int depth);
-	int alphaBeta(Board& board, int depth, int alpha, int beta, PieceColor maximizingPlayer);
+	int alphaBeta(Board& board, int depth, int alpha, int beta, int ply);
+	// Resolves captures and promotions at the horizon so the evaluation isn't taken mid-exchange
+	int quiescence(Board& board, int alpha, int beta, int ply, int qply);
+
+	// Asks a running search to stop as soon as possible. Safe to call from another thread
+	void stop() { stopRequested.store(true, std::memory_order_relaxed); }
+
+	const SearchStats& getStats() const { return stats; }
+
+private:
+	// Two quiet moves per ply that recently caused a beta cutoff, tried right after the captures
+	Move killers[MAX_PLY][2];
+
+	// Quiet move ordering beyond the killers, aged at the start of every search
+	ButterflyHistory history;
+	// The quiet move that last refuted a move, indexed by that move's from and to squares
+	Move counterMoves[64][64];
+	// The move being searched at each ply, so a node knows which move led to it
+	Move moveStack[MAX_PLY];
+	// The hash move left out of a singular extension search at that ply, none otherwise
+	Move excludedMoves[MAX_PLY];
+
+	// Triangular PV table: pvTable[ply] holds the best line found from ply to pvLength[ply]
+	Move pvTable[MAX_PLY][MAX_PLY];
+	int pvLength[MAX_PLY];
+
+	// Kept between searches so results carry over from one move to the next, and shared with the helpers
+	std::shared_ptr<TranspositionTable> tt;
+
+	SearchLimits limits;
+	SearchStats stats;
+	std::chrono::steady_clock::time_point startTime;
+	int64_t softTimeMs; // Don't start another iteration after this
+	int64_t hardTimeMs; // Abort the iteration in progress after this
+	std::atomic<bool> stopRequested;
+	bool stopped;
+
+	SearchParams params;
+	// Late move reductions by depth and move number, built from params
+	int reductions[MAX_PLY][64];
+	// Null moves aren't tried before this ply while a null-move fail high is being verified
+	int nullMoveMinPly;
+	// Depth of the current iteration, extensions stop at twice this many plies
+	int rootDepth;
+
+	// 0 for the main thread, which owns the helpers, the time management and the final move
+	int threadIndex;
+	std::vector<std::unique_ptr<Search>> helpers;
+
+	Search(std::shared_ptr<TranspositionTable> table, int threadIndex);
+	Move iterativeDeepening(Board& board);
+	void storeKiller(const Move& move, int ply);
+	void updateQuietStats(PieceColor color, const Move& bestMove, int ply, int depth, const Move* quietsTried, int quietCount);
+	void allocateTime();
+	int64_t elapsedMs() const;
+	bool shouldStop();
+	int searchRoot(Board& board, int depth, int alpha, int beta, MoveList& rootMoves);
+	void updatePV(int ply, const Move& move);
+	static void moveToFront(MoveList& moves, const Move& move);
 };
 
 #endif // SEARCH_HPP
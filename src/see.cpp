@@ -0,0 +1,161 @@
+#include "see.hpp"
+#include "attacks.hpp"
+#include "eval.hpp"
+#include <algorithm>
+
+// High enough that losing the king outweighs any material, so the king only captures last
+static const int SEE_KING_VALUE = 20000;
+
+// Attackers are tried cheapest first
+static const PieceType SEE_ORDER[6] = {
+    PieceType::PAWN, PieceType::KNIGHT, PieceType::BISHOP, PieceType::ROOK, PieceType::QUEEN, PieceType::KING
+};
+
+static int seeValue(PieceType pieceType) {
+    return pieceType == PieceType::KING ? SEE_KING_VALUE : Evaluation::pieceValue(pieceType);
+}
+
+// What the move itself wins: the captured piece, plus the promotion piece in place of the pawn
+static int moveGain(const Board& board, const Move& move) {
+    int gain = 0;
+    if (move.flags == MoveType::EN_PASSANT) {
+        gain = seeValue(PieceType::PAWN);
+    }
+    else if (move.flags == MoveType::CAPTURE) {
+        gain = seeValue(board.getPieceType(move.destRow, move.destCol));
+    }
+    if (move.promotionPiece != PieceType::EMPTY) {
+        gain += seeValue(move.promotionPiece) - seeValue(PieceType::PAWN);
+    }
+    return gain;
+}
+
+// The occupancy right after the move, with the moving piece on its destination square
+static uint64_t occupancyAfter(const Board& board, const Move& move) {
+    int srcSquare = move.srcRow * 8 + move.srcCol;
+    int destSquare = move.destRow * 8 + move.destCol;
+    uint64_t occupancy = (board.getOccupancy() ^ squareBit(srcSquare)) | squareBit(destSquare);
+    if (move.flags == MoveType::EN_PASSANT) {
+        occupancy ^= squareBit(move.srcRow * 8 + move.destCol); // The captured pawn stands beside the capturing one
+    }
+    return occupancy;
+}
+
+// Finds the least valuable attacker of the color in the attackers set, removes it from the occupancy and
+// adds any slider it uncovers on the square. Returns EMPTY if the color has no attacker left
+static PieceType popLeastValuableAttacker(const Board& board, int square, PieceColor color, uint64_t& attackers, uint64_t& occupancy) {
+    uint64_t ownAttackers = attackers & board.getOccupancy(color);
+    if (!ownAttackers) {
+        return PieceType::EMPTY;
+    }
+
+    for (PieceType pieceType : SEE_ORDER) {
+        uint64_t candidates = ownAttackers & board.getPieces(pieceType, color);
+        if (!candidates) {
+            continue;
+        }
+
+        occupancy ^= squareBit(bitScanForward(candidates));
+
+        // X-rays: only diagonal movers can uncover a bishop or queen, and only straight movers a rook or queen
+        if (pieceType == PieceType::PAWN || pieceType == PieceType::BISHOP || pieceType == PieceType::QUEEN) {
+            attackers |= bishopAttacks(square, occupancy) &
+                (board.getPieces(PieceType::BISHOP, PieceColor::WHITE) | board.getPieces(PieceType::QUEEN, PieceColor::WHITE) |
+                 board.getPieces(PieceType::BISHOP, PieceColor::BLACK) | board.getPieces(PieceType::QUEEN, PieceColor::BLACK));
+        }
+        if (pieceType == PieceType::ROOK || pieceType == PieceType::QUEEN) {
+            attackers |= rookAttacks(square, occupancy) &
+                (board.getPieces(PieceType::ROOK, PieceColor::WHITE) | board.getPieces(PieceType::QUEEN, PieceColor::WHITE) |
+                 board.getPieces(PieceType::ROOK, PieceColor::BLACK) | board.getPieces(PieceType::QUEEN, PieceColor::BLACK));
+        }
+        attackers &= occupancy;
+        return pieceType;
+    }
+    return PieceType::EMPTY;
+}
+
+int see(const Board& board, const Move& move) {
+    if (move.flags == MoveType::CASTLING) {
+        return 0;
+    }
+
+    int square = move.destRow * 8 + move.destCol;
+    PieceColor color = board.getPieceColor(move.srcRow, move.srcCol);
+    uint64_t occupancy = occupancyAfter(board, move);
+    uint64_t attackers = board.attackersTo(square, occupancy) & occupancy;
+
+    // gain[d] is what the side making the d-th capture has won so far if the exchange stops right after it
+    int gain[32];
+    int d = 0;
+    gain[0] = moveGain(board, move);
+    int onSquare = seeValue(move.promotionPiece != PieceType::EMPTY ? move.promotionPiece : board.getPieceType(move.srcRow, move.srcCol));
+
+    while (d < 31) {
+        color = color == PieceColor::WHITE ? PieceColor::BLACK : PieceColor::WHITE;
+        PieceType attacker = popLeastValuableAttacker(board, square, color, attackers, occupancy);
+        if (attacker == PieceType::EMPTY) {
+            break;
+        }
+
+        ++d;
+        gain[d] = onSquare - gain[d - 1];
+        onSquare = seeValue(attacker);
+    }
+
+    // Each side only recaptures if that is better than stopping
+    while (d > 0) {
+        gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
+        --d;
+    }
+    return gain[0];
+}
+
+bool seeGreaterOrEqual(const Board& board, const Move& move, int threshold) {
+    if (move.flags == MoveType::CASTLING) {
+        return threshold <= 0;
+    }
+
+    // Even if the moving piece is lost right away the move still has to reach the threshold
+    int swap = moveGain(board, move) - threshold;
+    if (swap < 0) {
+        return false;
+    }
+
+    // And if it can be lost for nothing and still reaches it, there is nothing left to work out
+    int onSquare = seeValue(move.promotionPiece != PieceType::EMPTY ? move.promotionPiece : board.getPieceType(move.srcRow, move.srcCol));
+    swap = onSquare - swap;
+    if (swap <= 0) {
+        return true;
+    }
+
+    int square = move.destRow * 8 + move.destCol;
+    PieceColor color = board.getPieceColor(move.srcRow, move.srcCol);
+    uint64_t occupancy = occupancyAfter(board, move);
+    uint64_t attackers = board.attackersTo(square, occupancy) & occupancy;
+
+    // result says whether the mover is at or above the threshold with the captures made so far. swap is how
+    // far the side that just captured would fall below (or above, for the other side) if it lost its piece
+    bool result = true;
+    while (true) {
+        color = color == PieceColor::WHITE ? PieceColor::BLACK : PieceColor::WHITE;
+        PieceType attacker = popLeastValuableAttacker(board, square, color, attackers, occupancy);
+        if (attacker == PieceType::EMPTY) {
+            break;
+        }
+        result = !result;
+
+        // A king can only capture if the other side has nothing left to recapture with
+        if (attacker == PieceType::KING) {
+            PieceColor other = color == PieceColor::WHITE ? PieceColor::BLACK : PieceColor::WHITE;
+            return (attackers & board.getOccupancy(other)) ? !result : result;
+        }
+
+        // Stop once the capturing side stays ahead even if it loses this attacker
+        swap = seeValue(attacker) - swap;
+        if (swap < (int)result) {
+            break;
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,17 @@
+#ifndef SEE_HPP
+#define SEE_HPP
+
+#include "board.hpp"
+#include "move.hpp"
+
+// Static exchange evaluation: the material the side to move wins (or loses, if negative) when the move
+// starts a sequence of captures on its destination square, with both sides always recapturing with
+// their least valuable piece and free to stop when going on would lose more. Sliders lined up behind
+// a capturing piece (x-rays) join in once it has left. Pins are ignored.
+int see(const Board& board, const Move& move);
+
+// Whether see(board, move) >= threshold, without working out the exact value. Cheaper, since the
+// exchange can stop as soon as the outcome relative to the threshold is known
+bool seeGreaterOrEqual(const Board& board, const Move& move, int threshold);
+
+#endif // SEE_HPP
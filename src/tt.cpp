@@ -0,0 +1,114 @@
+#include "tt.hpp"
+
+TranspositionTable::TranspositionTable(size_t megabytes) : bucketCount(0), bucketMask(0), generation(0) {
+    resize(megabytes);
+}
+
+void TranspositionTable::resize(size_t megabytes) {
+    size_t maxBuckets = megabytes * 1024 * 1024 / sizeof(TTBucket);
+
+    // Round down to a power of two so the bucket index is a mask of the key
+    size_t count = 1;
+    while (count * 2 <= maxBuckets) {
+        count *= 2;
+    }
+
+    buckets.reset(new TTBucket[count]);
+    bucketCount = count;
+    bucketMask = count - 1;
+    clear();
+}
+
+void TranspositionTable::clear() {
+    for (size_t i = 0; i < bucketCount; ++i) {
+        for (std::atomic<uint64_t>& entry : buckets[i].entries) {
+            entry.store(0, std::memory_order_relaxed);
+        }
+    }
+    generation = 0;
+}
+
+void TranspositionTable::newSearch() {
+    // Six bits of generation, wrapping around
+    generation = (generation + 1) & 63;
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry& entry) const {
+    const TTBucket& bucket = bucketFor(key);
+    uint16_t fragment = keyFragment(key);
+
+    for (const std::atomic<uint64_t>& slot : bucket.entries) {
+        TTEntry candidate = TTEntry::unpack(slot.load(std::memory_order_relaxed));
+        if (candidate.key16 == fragment && candidate.bound() != Bound::NONE) {
+            entry = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, int depth, int score, Bound bound, PackedMove move) {
+    TTBucket& bucket = bucketFor(key);
+    uint16_t fragment = keyFragment(key);
+
+    // Overwrite the same position if it is already stored, otherwise replace the entry that is
+    // worth least: empty slots first, then the shallowest, with every search of age counting as 8 plies.
+    // Entries are read once into local copies, other threads may be writing the bucket meanwhile
+    std::atomic<uint64_t>* replace = &bucket.entries[0];
+    TTEntry replaced = TTEntry::unpack(replace->load(std::memory_order_relaxed));
+    int worstValue = 1 << 30;
+    for (std::atomic<uint64_t>& slot : bucket.entries) {
+        TTEntry entry = TTEntry::unpack(slot.load(std::memory_order_relaxed));
+        if (entry.key16 == fragment && entry.bound() != Bound::NONE) {
+            replace = &slot;
+            replaced = entry;
+            break;
+        }
+
+        int value;
+        if (entry.bound() == Bound::NONE) {
+            value = -(1 << 20);
+        }
+        else {
+            int age = (generation - entry.generation()) & 63;
+            value = entry.depth - 8 * age;
+        }
+        if (value < worstValue) {
+            worstValue = value;
+            replace = &slot;
+            replaced = entry;
+        }
+    }
+
+    // Keep a deeper result for the same position from this search, unless the new one is exact
+    bool samePosition = replaced.key16 == fragment && replaced.bound() != Bound::NONE;
+    if (samePosition && bound != Bound::EXACT && replaced.generation() == generation && depth < replaced.depth) {
+        return;
+    }
+
+    if (move.isNull() && samePosition) {
+        move = replaced.packedMove();
+    }
+
+    TTEntry entry;
+    entry.key16 = fragment;
+    entry.move = move.raw();
+    entry.score = (int16_t)score;
+    entry.depth = (int8_t)depth;
+    entry.genBound = (uint8_t)((generation << 2) | (uint8_t)bound);
+    replace->store(entry.pack(), std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const {
+    size_t sample = bucketCount < 125 ? bucketCount : 125;
+    int used = 0;
+    for (size_t i = 0; i < sample; ++i) {
+        for (const std::atomic<uint64_t>& slot : buckets[i].entries) {
+            TTEntry entry = TTEntry::unpack(slot.load(std::memory_order_relaxed));
+            if (entry.bound() != Bound::NONE && entry.generation() == generation) {
+                ++used;
+            }
+        }
+    }
+    return sample ? (int)(used * 1000 / (sample * TTBucket::SIZE)) : 0;
+}
@@ -0,0 +1,92 @@
+#ifndef TT_HPP
+#define TT_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include "move.hpp"
+
+// How the stored score relates to the true score of the position
+enum class Bound : uint8_t {
+	NONE,  // Empty entry
+	EXACT, // The score is exact
+	LOWER, // The search failed high, the true score is at least this
+	UPPER  // The search failed low, the true score is at most this
+};
+
+// One 8-byte slot: the top 16 bits of the Zobrist key (the bucket index supplies the low bits),
+// the best move, score, search depth and the search generation packed together with the bound
+struct TTEntry {
+	uint16_t key16;
+	uint16_t move;
+	int16_t score;
+	int8_t depth;
+	uint8_t genBound; // Generation in the top 6 bits, Bound in the low 2
+
+	Bound bound() const { return (Bound)(genBound & 3); }
+	uint8_t generation() const { return genBound >> 2; }
+	PackedMove packedMove() const { return PackedMove::fromRaw(move); }
+
+	// The whole entry as one word, so it can be read and written with a single atomic access
+	uint64_t pack() const {
+		uint64_t data;
+		std::memcpy(&data, this, sizeof(data));
+		return data;
+	}
+	static TTEntry unpack(uint64_t data) {
+		TTEntry entry;
+		std::memcpy(&entry, &data, sizeof(entry));
+		return entry;
+	}
+};
+
+static_assert(sizeof(TTEntry) == 8, "TTEntry must stay 8 bytes");
+
+// Eight entries filling one 64-byte cache line, so a probe touches a single line. Each entry is one
+// atomic word: threads sharing the table never see half-written entries and need no locks. Two threads
+// storing the same slot at once just leave one of the results, and every probed move is checked for
+// legality before it is played anyway
+struct alignas(64) TTBucket {
+	static const int SIZE = 8;
+	std::atomic<uint64_t> entries[SIZE];
+};
+
+static_assert(sizeof(TTBucket) == 64, "TTBucket must be one cache line");
+
+class TranspositionTable {
+public:
+	static const size_t DEFAULT_SIZE_MB = 16;
+
+	explicit TranspositionTable(size_t megabytes = DEFAULT_SIZE_MB);
+
+	// Reallocates to the largest power-of-two number of buckets that fits in the given size, clearing the table
+	void resize(size_t megabytes);
+	void clear();
+
+	// Called once per search, before any helper threads start, so entries from earlier searches are replaced first
+	void newSearch();
+
+	// Copies the entry for the key into entry and returns true if the position is in the table
+	bool probe(uint64_t key, TTEntry& entry) const;
+
+	// Safe to call from several threads at once, as is probe
+	// Stores a search result. A null move keeps the move already stored for the same position
+	void store(uint64_t key, int depth, int score, Bound bound, PackedMove move);
+
+	// Permille of entries written during the current search, sampled from the first buckets
+	int hashfull() const;
+
+private:
+	std::unique_ptr<TTBucket[]> buckets;
+	size_t bucketCount;
+	uint64_t bucketMask;
+	uint8_t generation;
+
+	TTBucket& bucketFor(uint64_t key) { return buckets[key & bucketMask]; }
+	const TTBucket& bucketFor(uint64_t key) const { return buckets[key & bucketMask]; }
+	static uint16_t keyFragment(uint64_t key) { return (uint16_t)(key >> 48); }
+};
+
+#endif // TT_HPP
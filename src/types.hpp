@@ -0,0 +1,25 @@
+#ifndef TYPES_HPP
+#define TYPES_HPP
+
+#include <cstdint>
+
+// Piece enums shared by the engine and the GUI. Kept free of SDL so the engine
+// (and tools like perft) can be built without it
+
+enum class PieceType : uint8_t {
+	PAWN,
+	ROOK,
+	KNIGHT,
+	BISHOP,
+	QUEEN,
+	KING,
+	EMPTY
+};
+
+enum class PieceColor : uint8_t {
+	WHITE,
+	BLACK,
+	EMPTY
+};
+
+#endif // TYPES_HPP
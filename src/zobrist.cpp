@@ -0,0 +1,52 @@
+#include "zobrist.hpp"
+
+uint64_t zobristPieces[2][6][64];
+uint64_t zobristCastling[16];
+uint64_t zobristEnPassant[8];
+uint64_t zobristSide;
+
+// Fixed-seed splitmix64, so keys are the same on every run and hashes can be shared between runs
+static uint64_t nextKey(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static bool buildZobristKeys() {
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+
+    for (int color = 0; color < 2; ++color) {
+        for (int type = 0; type < 6; ++type) {
+            for (int square = 0; square < 64; ++square) {
+                zobristPieces[color][type][square] = nextKey(state);
+            }
+        }
+    }
+
+    // Each castling right gets its own key, combinations are the XOR of the rights they contain
+    uint64_t rightKeys[4];
+    for (int i = 0; i < 4; ++i) {
+        rightKeys[i] = nextKey(state);
+    }
+    for (int rights = 0; rights < 16; ++rights) {
+        zobristCastling[rights] = 0;
+        for (int i = 0; i < 4; ++i) {
+            if (rights & (1 << i)) {
+                zobristCastling[rights] ^= rightKeys[i];
+            }
+        }
+    }
+
+    for (int file = 0; file < 8; ++file) {
+        zobristEnPassant[file] = nextKey(state);
+    }
+
+    zobristSide = nextKey(state);
+    return true;
+}
+
+void initZobristKeys() {
+    static const bool initialized = buildZobristKeys();
+    (void)initialized;
+}
@@ -0,0 +1,15 @@
+#ifndef ZOBRIST_HPP
+#define ZOBRIST_HPP
+
+#include <cstdint>
+
+// Random keys XORed together to form a 64-bit position key
+extern uint64_t zobristPieces[2][6][64]; // [color][piece type][square]
+extern uint64_t zobristCastling[16];     // Indexed by the castling rights bits
+extern uint64_t zobristEnPassant[8];     // Indexed by the en passant file
+extern uint64_t zobristSide;             // XORed in when black is to move
+
+// Builds the key tables. Safe to call more than once, the keys are only generated the first time
+void initZobristKeys();
+
+#endif // ZOBRIST_HPP
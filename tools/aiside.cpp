@@ -0,0 +1,55 @@
+// Headless check of the AI's turn logic, built without SDL from the engine sources:
+//   g++ -O2 -std=c++17 -pthread -Isrc tools/aiside.cpp src/ai.cpp src/attacks.cpp src/board.cpp src/eval.cpp src/log.cpp src/movegen.cpp src/movepick.cpp src/search.cpp src/see.cpp src/tt.cpp src/zobrist.cpp -o aiside
+// Usage: aiside   (prints each case and exits with 1 if any of them fails)
+
+#include <iostream>
+#include "ai.hpp"
+#include "board.hpp"
+
+static bool check(const char* name, bool passed) {
+    std::cout << (passed ? "ok     " : "FAILED ") << name << std::endl;
+    return passed;
+}
+
+// True if move is a move by a piece of the given color
+static bool movesPieceOf(const Board& board, const Move& move, PieceColor color) {
+    return move.srcRow >= 0 && board.getPieceColor(move.srcRow, move.srcCol) == color;
+}
+
+int main() {
+    bool passed = true;
+
+    // The player took white: the game opens on the player's turn, which is how the GUI picks the first mover
+    Board board;
+    board.initializeFromFEN();
+    board.setRealPlayer(PieceColor::WHITE);
+    board.setAIPlayer(PieceColor::BLACK);
+    passed &= check("AI as black doesn't move first", !AI::isAITurn(board));
+
+    // Once white has moved it is the AI's turn, and it answers with a black piece
+    board.makeMove(6, 4, 4, 4); // e2-e4
+    passed &= check("AI as black moves after 1. e4", AI::isAITurn(board));
+    passed &= check("AI as black answers 1. e4 with a black piece", movesPieceOf(board, AI::findBestMove(board, 3), PieceColor::BLACK));
+
+    // The player took black: the AI opens the game with a white piece
+    Board whiteBoard;
+    whiteBoard.initializeFromFEN();
+    whiteBoard.setRealPlayer(PieceColor::BLACK);
+    whiteBoard.setAIPlayer(PieceColor::WHITE);
+    passed &= check("AI as white moves first", AI::isAITurn(whiteBoard));
+    passed &= check("AI as white opens with a white piece", movesPieceOf(whiteBoard, AI::findBestMove(whiteBoard, 3), PieceColor::WHITE));
+
+    // The search itself doesn't care about seats: asked on the player's turn it analyses for the side to move
+    Board analysisBoard;
+    analysisBoard.initializeFromFEN();
+    analysisBoard.setAIPlayer(PieceColor::BLACK);
+    passed &= check("search on the player's turn analyses for the side to move",
+        movesPieceOf(analysisBoard, AI::findBestMove(analysisBoard, 3), PieceColor::WHITE));
+
+    // Without seats assigned the AI never claims a turn
+    Board emptyBoard;
+    emptyBoard.initializeFromFEN();
+    passed &= check("no AI player means it's never the AI's turn", !AI::isAITurn(emptyBoard));
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,73 @@
+// Headless perft benchmark, built without SDL from the engine sources:
+//   g++ -O2 -std=c++17 -pthread -Isrc tools/perft.cpp src/attacks.cpp src/board.cpp src/movegen.cpp src/perft.cpp src/zobrist.cpp src/log.cpp -o perft
+// Usage: perft [-t threads] [-H hashMB] [-q] <depth> [FEN]   (the FEN defaults to the starting position)
+//   -t  worker threads (default 1)
+//   -H  shared subtree count table size in MB (default 0, no table)
+//   -q  only print the total, not the count for every root move
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "board.hpp"
+#include "perft.hpp"
+
+static int usage(const char* program) {
+    std::cout << "Usage: " << program << " [-t threads] [-H hashMB] [-q] <depth> [FEN]" << std::endl;
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    PerftOptions options;
+
+    int arg = 1;
+    while (arg < argc && argv[arg][0] == '-') {
+        if (std::strcmp(argv[arg], "-q") == 0) {
+            options.printDivide = false;
+            arg += 1;
+        }
+        else if (std::strcmp(argv[arg], "-t") == 0 && arg + 1 < argc) {
+            options.threads = std::atoi(argv[arg + 1]);
+            arg += 2;
+        }
+        else if (std::strcmp(argv[arg], "-H") == 0 && arg + 1 < argc) {
+            options.hashSizeMB = (size_t)std::atoll(argv[arg + 1]);
+            arg += 2;
+        }
+        else {
+            return usage(argv[0]);
+        }
+    }
+
+    if (arg >= argc) {
+        return usage(argv[0]);
+    }
+
+    int depth = std::atoi(argv[arg++]);
+    if (depth < 1) {
+        std::cout << "Depth must be at least 1" << std::endl;
+        return 1;
+    }
+
+    // The FEN fields may be passed as one quoted argument or as separate arguments
+    std::string fen;
+    for (; arg < argc; ++arg) {
+        if (!fen.empty()) {
+            fen += ' ';
+        }
+        fen += argv[arg];
+    }
+    if (fen.empty()) {
+        fen = Board::START_FEN;
+    }
+
+    Board board;
+    std::string_view error;
+    if (!board.setFromFEN(fen, &error)) {
+        std::cout << "Invalid FEN: " << error << std::endl;
+        return 1;
+    }
+
+    perftDivide(board, depth, options);
+    return 0;
+}